@@ -1,36 +1,68 @@
 #include<iostream>
 #include<bits/stdc++.h>
 #include"library.h"
+#include"journalstorage.h"
+#include"sharedinventory.h"
+#include"inventorylock.h"
 using namespace std;
 
-
-int main ()
+// Usage: add_books_to_shelf                                      (type the books in)
+//        add_books_to_shelf --import delivery.csv [inventory.txt] (merge a CSV delivery, no prompts)
+// Either way the books are merged into the inventory by title: known titles get more copies, new
+// titles are appended, and the inventory file is written once at the end.
+// The inventory is read and written through JournaledFileStorage, like the terminals and the server,
+// so sales they journaled since the last snapshot are replayed first and the journal is then cleared.
+int main (int argc, char* argv[])
 {
-    unique_ptr<FileStorageBase> fileStorage = make_unique<FileStorageFromFile>();
+    bool importing = argc >= 3 && string(argv[1]) == "--import";
+    string inventoryFile = importing && argc >= 4 ? argv[3] : "inventory.txt";
+    vector<Book> delivery;
+    // A running server or terminal would keep journaling its own stale quantities and later
+    // compact them over the delivery, so hold the inventory until the merged file is written
+    InventoryLock lock(inventoryFile, InventoryLock::Mode::Exclusive);
+    if (!lock.held() || SharedInventory::terminalSegmentBlocks()) {
+        return 1;
+    }
+    FileStorageFromFile loader(thread::hardware_concurrency());
 
-    Library library(move(fileStorage));
-    string title,author;
-    int n,price,quantity;
-    cout<<"enter number of unique books you want to add to shelf: ";
-    cin>>n;
-    for(int i=0;i<n ;i++){
-        cout<<"enter title of the book: ";
-        cin>>title;
-        cout<<"enter author of the book: ";
-        cin>>author;
-        cout<<"enter price of the book: ";
-        cin>>price;
-        cout<<"number of quatity to be added: ";
-        cin>>quantity;
-        cout<<"enter title of the book: ";
-        library.addBook(Book(title,author,price,quantity));
+    if (importing) {
+        // Delivery rows use the inventory format: ID,Title,Author,Price,Quantity
+        auto start = chrono::steady_clock::now();
+        delivery = loader.loadFromFile(argv[2]);
+        cout << "Read " << delivery.size() << " rows from " << argv[2] << " in "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+    } else {
+        string title,author;
+        int n,price,quantity;
+        cout<<"enter number of unique books you want to add to shelf: ";
+        cin>>n;
+        for(int i=0;i<n ;i++){
+            cout<<"enter title of the book: ";
+            cin>>title;
+            cout<<"enter author of the book: ";
+            cin>>author;
+            cout<<"enter price of the book: ";
+            cin>>price;
+            cout<<"number of quatity to be added: ";
+            cin>>quantity;
+            delivery.emplace_back(title,author,price,quantity);
+        }
     }
 
-    // Load inventory from file
-    library.loadInventory("inventory.txt");
+    // Load the current inventory (snapshot plus journal) without re-saving it; mergeBooks writes the
+    // file once, which also empties the journal
+    auto start = chrono::steady_clock::now();
+    auto storage = make_unique<JournaledFileStorage>(4096, thread::hardware_concurrency());
+    vector<Book> current = storage->loadFromFile(inventoryFile);
+    Library library(std::move(storage), inventoryFile);
+    library.addBooks(std::move(current));
+    MergeResult merged = library.mergeBooks(std::move(delivery));
+    cout << "Restocked " << merged.restocked << " rows, added " << merged.added << " new titles in "
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
 
-    // Display inventory
-    cout << "Current Inventory:\n";
-    library.displayInventory();
+    if (library.getInventory().size() <= 50) {
+        cout << "Current Inventory:\n";
+        library.displayInventory();
+    }
 return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,106 @@
+#ifndef ASYNCPERSISTENCE_H
+#define ASYNCPERSISTENCE_H
+
+#include <vector>
+#include <span>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+using namespace std;
+
+// PersistenceWriter Class: Background group-commit stage for storage writes
+// Callers mark inventory slots dirty and return at once; a writer thread collects the marks and
+// hands them to the flush function in one call when the interval passes or enough changes pile up.
+// Slots changed many times between flushes are written once.
+class PersistenceWriter {
+public:
+    using FlushFunction = function<void(span<const size_t> slots)>;
+
+    PersistenceWriter(FlushFunction flushFunction, chrono::milliseconds interval, size_t maxPending)
+        : flushFunction(std::move(flushFunction)), interval(interval), maxPending(maxPending),
+          worker([this] { run(); }) {}
+
+    // Write out everything still pending, then stop the writer thread
+    ~PersistenceWriter() {
+        {
+            lock_guard lock(mutex_);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    PersistenceWriter(const PersistenceWriter&) = delete;
+    PersistenceWriter& operator=(const PersistenceWriter&) = delete;
+
+    // Queue slots to be written; never waits for I/O
+    void markDirty(span<const size_t> slots) {
+        bool full;
+        {
+            lock_guard lock(mutex_);
+            pending.insert(pending.end(), slots.begin(), slots.end());
+            requested++;
+            full = pending.size() >= maxPending;
+        }
+        if (full) {
+            wake.notify_one();
+        }
+    }
+
+    // Durability barrier: returns once every change marked before the call has been written
+    void flush() {
+        unique_lock lock(mutex_);
+        uint64_t target = requested;
+        flushRequested = true;
+        wake.notify_one();
+        written.wait(lock, [&] { return completed >= target; });
+    }
+
+private:
+    void run() {
+        unique_lock lock(mutex_);
+        while (true) {
+            wake.wait_for(lock, interval, [&] { return stopping || flushRequested || pending.size() >= maxPending; });
+            if (pending.empty()) {
+                completed = requested;
+                flushRequested = false;
+                written.notify_all();
+                if (stopping) {
+                    return;
+                }
+                continue;
+            }
+            vector<size_t> batch;
+            batch.swap(pending);
+            uint64_t batchEnd = requested;
+            flushRequested = false;
+            lock.unlock();
+
+            sort(batch.begin(), batch.end());
+            batch.erase(unique(batch.begin(), batch.end()), batch.end());
+            flushFunction(batch);
+
+            lock.lock();
+            completed = batchEnd;
+            written.notify_all();
+        }
+    }
+
+    FlushFunction flushFunction;  // Writes a group of slots to storage
+    chrono::milliseconds interval;  // Longest a change waits before being written
+    size_t maxPending;  // Pending marks that trigger an early write
+    mutex mutex_;
+    condition_variable wake;  // Wakes the writer thread early
+    condition_variable written;  // Signals flush() callers after each write
+    vector<size_t> pending;  // Slots marked since the last write (may repeat)
+    uint64_t requested = 0;  // markDirty calls so far
+    uint64_t completed = 0;  // markDirty calls covered by finished writes
+    bool flushRequested = false;
+    bool stopping = false;
+    thread worker;  // Declared last so it starts after every other member is ready
+};
+
+#endif // ASYNCPERSISTENCE_H
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Naive versions of the analytics queries: one pass over the Book objects each
+
+static long long naiveStockValueCents(const vector<Book>& inventory) {
+    long long total = 0;
+    for (const auto& book : inventory) {
+        total += book.getPriceCents() * book.getQuantity();
+    }
+    return total;
+}
+
+static vector<size_t> naiveLowStock(const vector<Book>& inventory, int threshold) {
+    vector<size_t> slots;
+    for (size_t i = 0; i < inventory.size(); i++) {
+        if (inventory[i].getQuantity() < threshold) {
+            slots.push_back(i);
+        }
+    }
+    return slots;
+}
+
+static vector<size_t> naivePriceBands(const vector<Book>& inventory, const vector<int64_t>& edges) {
+    vector<size_t> bands(edges.size() + 1);
+    for (const auto& book : inventory) {
+        size_t band = upper_bound(edges.begin(), edges.end(), book.getPriceCents()) - edges.begin();
+        bands[band]++;
+    }
+    return bands;
+}
+
+// Compare whole-inventory scans over vector<Book> with the same queries over InventoryColumns,
+// then check the Library query methods against the naive answers after a round of sales.
+// Usage: analytics_bench [books] [template inventory]   (defaults: 10000000 inventory.txt)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 10000000;
+    string templateFile = argc > 2 ? argv[2] : "inventory.txt";
+    vector<Book> inventory = syntheticInventory(books, templateFile);
+    mt19937 rng(5);
+    uniform_int_distribution<int> stock(0, 60);
+    for (auto& book : inventory) {
+        book.setQuantity(stock(rng));
+    }
+    InventoryColumns columns;
+    columns.reserve(books);
+    for (const auto& book : inventory) {
+        columns.append(book);
+    }
+
+    const int repeats = 5;
+    const int threshold = 5;
+    const vector<int64_t> edges = {20000, 40000, 60000, 80000};
+    long long valueNaive = 0, valueColumns = 0;
+    vector<size_t> lowNaive, lowColumns, bandsNaive, bandsColumns;
+    LatencyRecorder recorder;
+    for (int r = 0; r < repeats; r++) {
+        recorder.measure([&] { valueNaive = naiveStockValueCents(inventory); });
+    }
+    recorder.report("totalStockValue", books, "naive");
+    for (int r = 0; r < repeats; r++) {
+        recorder.measure([&] { valueColumns = stockValueCents(columns.prices(), columns.stock()); });
+    }
+    recorder.report("totalStockValue", books, "columns");
+    for (int r = 0; r < repeats; r++) {
+        recorder.measure([&] { lowNaive = naiveLowStock(inventory, threshold); });
+    }
+    recorder.report("lowStock", books, "naive");
+    for (int r = 0; r < repeats; r++) {
+        recorder.measure([&] { lowColumns = slotsBelow(columns.stock(), threshold); });
+    }
+    recorder.report("lowStock", books, "columns");
+    for (int r = 0; r < repeats; r++) {
+        recorder.measure([&] { bandsNaive = naivePriceBands(inventory, edges); });
+    }
+    recorder.report("priceBandCounts", books, "naive");
+    for (int r = 0; r < repeats; r++) {
+        recorder.measure([&] { bandsColumns = priceBands(columns.prices(), edges); });
+    }
+    recorder.report("priceBandCounts", books, "columns");
+    if (valueNaive != valueColumns || lowNaive != lowColumns || bandsNaive != bandsColumns) {
+        cerr << "column kernels disagree with the naive scans" << endl;
+        return 1;
+    }
+    columns = InventoryColumns();
+
+    // The Library keeps its own columns in step with sales and restocks; check a smaller catalog
+    inventory.erase(inventory.begin() + min<size_t>(books, 200000), inventory.end());
+    Library library(make_unique<NullStorage>());
+    for (const auto& book : inventory) {
+        library.addBook(book);
+    }
+    uniform_int_distribution<size_t> pick(0, inventory.size() - 1);
+    for (int i = 0; i < 100000; i++) {
+        size_t slot = pick(rng);
+        if (i % 4 == 0) {
+            library.updateStock(inventory[slot].getTitle(), 3);
+        } else {
+            library.sellBookAt(slot);
+        }
+    }
+    library.applyBatch({{inventory[0].getTitle(), -1}, {inventory[1].getTitle(), 2}});
+    const vector<Book>& sold = library.getInventory();
+    vector<double> priceEdges;
+    for (int64_t edge : edges) {
+        priceEdges.push_back(edge / 100.0);
+    }
+    if (library.totalStockValueCents() != naiveStockValueCents(sold) ||
+        library.lowStock(threshold) != naiveLowStock(sold, threshold) ||
+        library.priceBandCounts(priceEdges) != naivePriceBands(sold, edges)) {
+        cerr << "library columns drifted from the books" << endl;
+        return 1;
+    }
+    return 0;
+}
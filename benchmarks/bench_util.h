@@ -0,0 +1,97 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../filestorage.h"
+using namespace std;
+
+// NullStorage: Storage backend that does nothing, so benchmarks never touch inventory.txt
+class NullStorage : public FileStorageBase {
+public:
+    void saveToFile(const vector<Book>& inventory, const string& filename) override {}
+    vector<Book> loadFromFile(const string& filename) override { return {}; }
+};
+
+// NullBuffer: Stream buffer that drops everything (used to silence or time console output)
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char* s, streamsize n) override { return n; }
+};
+
+// CoutSilencer: Redirects cout to a NullBuffer for its lifetime
+class CoutSilencer {
+public:
+    CoutSilencer() : saved(cout.rdbuf(&sink)) {}
+    ~CoutSilencer() { cout.rdbuf(saved); }
+
+private:
+    NullBuffer sink;
+    streambuf* saved;
+};
+
+// Build a synthetic inventory of the given size by cycling through template rows.
+// Titles get the row number appended so every title is unique.
+inline vector<Book> syntheticInventory(size_t books, const string& templateFile = "inventory.txt") {
+    FileStorageFromFile storage;
+    vector<Book> rows = storage.loadFromFile(templateFile);
+    if (rows.empty()) {
+        rows.emplace_back("book", "author", 100, 10);
+    }
+    vector<Book> inventory;
+    inventory.reserve(books);
+    for (size_t i = 0; i < books; i++) {
+        const Book& row = rows[i % rows.size()];
+        inventory.emplace_back(row.getTitle() + " " + to_string(i), row.getAuthor(), row.getPrice(), row.getQuantity());
+    }
+    return inventory;
+}
+
+// LatencyRecorder: Collects per-operation latencies and reports them as one JSON line
+class LatencyRecorder {
+public:
+    using Clock = chrono::steady_clock;
+
+    void reserve(size_t ops) { samples.reserve(ops); }
+
+    // Time one call of op
+    template <typename F>
+    void measure(F&& op) {
+        auto start = Clock::now();
+        op();
+        samples.push_back(chrono::duration<double, nano>(Clock::now() - start).count());
+    }
+
+    // Print {"bench":..., "books":..., "ops":..., "ops_per_sec":..., "p50_ns":..., "p99_ns":...}
+    void report(const string& bench, size_t books, const string& variant = "") {
+        if (samples.empty()) {
+            return;
+        }
+        double total = 0;
+        for (double s : samples) {
+            total += s;
+        }
+        sort(samples.begin(), samples.end());
+        cout << "{\"bench\":\"" << bench << "\"";
+        if (!variant.empty()) {
+            cout << ",\"variant\":\"" << variant << "\"";
+        }
+        cout << ",\"books\":" << books << ",\"ops\":" << samples.size()
+             << ",\"ops_per_sec\":" << samples.size() / (total / 1e9)
+             << ",\"p50_ns\":" << percentile(0.50) << ",\"p99_ns\":" << percentile(0.99)
+             << ",\"max_ns\":" << samples.back() << "}" << endl;
+        samples.clear();
+    }
+
+private:
+    double percentile(double p) const { return samples[min(samples.size() - 1, size_t(p * samples.size()))]; }
+
+    vector<double> samples;  // Nanoseconds per operation
+};
+
+#endif // BENCH_UTIL_H
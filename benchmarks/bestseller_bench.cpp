@@ -0,0 +1,98 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Sell skewed random titles from a large catalog with and without enableSalesTracking, then compare
+// the tracker's top-100 and reorder list with what a full sort and scan of the catalog give.
+// Reports sales/sec both ways and the time per query (the first tracked query also ranks every sale
+// made since tracking began), and fails if the answers differ.
+// Usage: bestseller_bench [books] [sales]   (defaults: 1000000 2000000)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 1000000;
+    size_t sales = argc > 2 ? stoull(argv[2]) : 2000000;
+    const size_t top = 100;
+    const int reorderThreshold = 5;
+
+    vector<Book> inventory;
+    inventory.reserve(books);
+    mt19937 rng(21);
+    for (size_t i = 0; i < books; i++) {
+        inventory.emplace_back("title " + to_string(i), "author", 10 + i % 40, reorderThreshold + rng() % 30);
+    }
+    // Skewed demand: a few titles sell far more than the rest
+    vector<size_t> orders(sales);
+    uniform_real_distribution<double> unit(0, 1);
+    for (auto& slot : orders) {
+        double u = unit(rng);
+        slot = min(books - 1, size_t(books * u * u * u));
+    }
+
+    auto elapsedMs = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    Library plain(make_unique<NullStorage>()), tracked(make_unique<NullStorage>());
+    plain.addBooks(inventory);
+    tracked.addBooks(std::move(inventory));
+    tracked.enableSalesTracking(reorderThreshold);
+
+    vector<long long> sold(books);  // Units sold per slot, counted here for the brute-force answers
+    auto start = chrono::steady_clock::now();
+    for (size_t slot : orders) {
+        plain.sellBookAt(slot);
+    }
+    double plainMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    for (size_t slot : orders) {
+        sold[slot] += tracked.sellBookAt(slot);
+    }
+    double trackedMs = elapsedMs(start);
+    tracked.updateStock("title 0", 40);  // Restocks move titles off the reorder list
+    plain.updateStock("title 0", 40);
+
+    // Today's way: rank every title by units sold, and scan every quantity
+    start = chrono::steady_clock::now();
+    vector<size_t> ranked(books);
+    for (size_t i = 0; i < books; i++) {
+        ranked[i] = i;
+    }
+    partial_sort(ranked.begin(), ranked.begin() + min(top, books), ranked.end(), [&](size_t a, size_t b) {
+        return sold[a] != sold[b] ? sold[a] > sold[b] : a < b;
+    });
+    double sortMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    vector<size_t> scanned = plain.lowStock(reorderThreshold);
+    double scanMs = elapsedMs(start);
+
+    // The first query ranks the sales noted since the last one; later queries only walk the heap
+    start = chrono::steady_clock::now();
+    vector<pair<size_t, long long>> best = tracked.topSellers(top);
+    double catchUpMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    best = tracked.topSellers(top);
+    double topMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    vector<size_t> reorder = tracked.lowStock(reorderThreshold);
+    double reorderMs = elapsedMs(start);
+
+    bool ok = reorder == scanned && best.size() == min(top, books);
+    for (size_t i = 0; ok && i < best.size(); i++) {
+        ok = best[i].first == ranked[i] && best[i].second == sold[ranked[i]] && tracked.unitsSold(ranked[i]) == sold[ranked[i]];
+    }
+
+    cout << "{\"bench\":\"bestsellers\",\"books\":" << books << ",\"sales\":" << sales
+         << ",\"sales_per_sec\":" << sales / (plainMs / 1000) << ",\"tracked_sales_per_sec\":" << sales / (trackedMs / 1000)
+         << ",\"top_sort_ms\":" << sortMs << ",\"top_tracked_first_ms\":" << catchUpMs << ",\"top_tracked_ms\":" << topMs
+         << ",\"low_stock_scan_ms\":" << scanMs << ",\"low_stock_tracked_ms\":" << reorderMs
+         << ",\"low_stock_titles\":" << reorder.size() << ",\"top_units\":" << (best.empty() ? 0 : best[0].second) << "}" << endl;
+    if (!ok) {
+        cerr << "tracked bestsellers or reorder list differ from the full sort and scan" << endl;
+        return 1;
+    }
+    return 0;
+}
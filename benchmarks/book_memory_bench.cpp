@@ -0,0 +1,58 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <malloc.h>
+#include "bench_util.h"
+using namespace std;
+
+// LegacyBook: The previous Book layout (two owned strings, double price), kept for comparison
+struct LegacyBook {
+    string title;
+    string author;
+    double price;
+    int quantity;
+};
+
+// Bytes currently allocated from malloc
+static size_t heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;  // Small chunks plus large mmap-backed blocks
+}
+
+// Measure heap bytes per book for the old and the compact Book layout.
+// Usage: book_memory_bench [books] [template inventory]   (defaults: 1000000 inventory.txt)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 1000000;
+    string templateFile = argc > 2 ? argv[2] : "inventory.txt";
+    vector<Book> rows = FileStorageFromFile().loadFromFile(templateFile);
+    if (rows.empty()) {
+        rows.emplace_back("book", "author", 100, 10);
+    }
+
+    cout << "{\"bench\":\"bookMemory\",\"books\":" << books
+         << ",\"legacy_sizeof\":" << sizeof(LegacyBook) << ",\"compact_sizeof\":" << sizeof(Book);
+
+    size_t before = heapInUse();
+    {
+        vector<LegacyBook> legacy;
+        legacy.reserve(books);
+        for (size_t i = 0; i < books; i++) {
+            const Book& row = rows[i % rows.size()];
+            legacy.push_back({row.getTitle() + " " + to_string(i), row.getAuthor(), row.getPrice(), row.getQuantity()});
+        }
+        cout << ",\"legacy_bytes_per_book\":" << double(heapInUse() - before) / books;
+    }
+
+    before = heapInUse();
+    {
+        vector<Book> compact;
+        compact.reserve(books);
+        for (size_t i = 0; i < books; i++) {
+            const Book& row = rows[i % rows.size()];
+            compact.emplace_back(row.getTitle() + " " + to_string(i), row.getAuthor(), row.getPrice(), row.getQuantity());
+        }
+        cout << ",\"compact_bytes_per_book\":" << double(heapInUse() - before) / books;
+    }
+    cout << "}" << endl;
+    return 0;
+}
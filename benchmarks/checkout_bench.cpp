@@ -0,0 +1,118 @@
+#include <iostream>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../customer.h"
+using namespace std;
+
+// Total copies left across the library
+static long long totalStock(const Library& library) {
+    long long total = 0;
+    for (const auto& book : library.getInventory()) {
+        total += book.getQuantity();
+    }
+    return total;
+}
+
+static void report(const string& variant, size_t checkouts, double ms, long long latencyMs) {
+    cout << "{\"bench\":\"checkout\",\"variant\":\"" << variant << "\",\"checkouts\":" << checkouts
+         << ",\"payment_latency_ms\":" << latencyMs << ",\"ms\":" << ms
+         << ",\"ops_per_sec\":" << checkouts / (ms / 1000) << "}" << endl;
+}
+
+// Compare blocking Customer::buyBook with the asynchronous CheckoutPipeline against a payment
+// provider that takes a fixed time to answer, then check the stock accounting of each run.
+// Usage: checkout_bench [payment latency ms] [pipeline checkouts] [pool threads]   (defaults: 20 20000 4)
+int main(int argc, char* argv[]) {
+    chrono::milliseconds latency(argc > 1 ? stoll(argv[1]) : 20);
+    size_t checkouts = argc > 2 ? stoull(argv[2]) : 20000;
+    size_t threads = argc > 3 ? stoull(argv[3]) : 4;
+    const size_t books = 1000;
+    const int initialStock = 1000;
+    bool ok = true;
+
+    auto makeLibrary = [&] {
+        auto library = make_unique<Library>(make_unique<NullStorage>());
+        for (size_t i = 0; i < books; i++) {
+            library->addBook(Book("title " + to_string(i), "author", 100, initialStock));
+        }
+        return library;
+    };
+    auto elapsedMs = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+
+    // Blocking checkout: each purchase waits for the provider, so throughput is 1 / latency
+    {
+        auto library = makeLibrary();
+        Customer customer("sync", make_shared<SimulatedOnlinePayment>(latency));
+        size_t syncCheckouts = max<size_t>(1, 2000 / max<long long>(latency.count(), 1));
+        size_t sold = 0;
+        auto start = chrono::steady_clock::now();
+        {
+            CoutSilencer quiet;
+            for (size_t i = 0; i < syncCheckouts; i++) {
+                sold += customer.buyBook(*library, "title " + to_string(i % books));
+            }
+        }
+        report("sync", syncCheckouts, elapsedMs(start), latency.count());
+        ok = ok && totalStock(*library) == (long long)(books * initialStock - sold);
+    }
+
+    // Pipelined checkout, one payment in ten declined
+    {
+        auto library = makeLibrary();
+        auto payment = make_shared<SimulatedOnlinePayment>(latency, 10);
+        Customer customer("async", payment);
+        vector<future<CheckoutStatus>> results;
+        results.reserve(checkouts);
+        size_t completed = 0, declined = 0;
+        auto start = chrono::steady_clock::now();
+        {
+            CheckoutPipeline pipeline(*library, threads);
+            for (size_t i = 0; i < checkouts; i++) {
+                results.push_back(customer.buyBookAsync(pipeline, "title " + to_string(i % books)));
+            }
+            for (auto& result : results) {
+                CheckoutStatus status = result.get();
+                completed += status == CheckoutStatus::Completed;
+                declined += status == CheckoutStatus::Declined;
+            }
+            // Settled checkouts must not stay queued (with their state) until the timeout
+            if (size_t queued = pipeline.pendingTimeouts()) {
+                cerr << "pipeline: " << queued << " timeouts still queued after every checkout settled" << endl;
+                ok = false;
+            }
+        }
+        report("pipeline", checkouts, elapsedMs(start), latency.count());
+        if (completed + declined != checkouts || totalStock(*library) != (long long)(books * initialStock - completed)) {
+            cerr << "pipeline stock mismatch: " << completed << " completed, " << declined << " declined" << endl;
+            ok = false;
+        }
+    }
+
+    // Provider slower than the timeout: every reservation must be released and every approval refunded
+    {
+        auto library = makeLibrary();
+        auto payment = make_shared<SimulatedOnlinePayment>(latency * 2);
+        size_t timedOut = 0;
+        {
+            CheckoutPipeline pipeline(*library, threads, latency / 2);
+            vector<future<CheckoutStatus>> results;
+            for (size_t i = 0; i < 1000; i++) {
+                results.push_back(pipeline.checkout("title " + to_string(i % books), payment));
+            }
+            for (auto& result : results) {
+                timedOut += result.get() == CheckoutStatus::TimedOut;
+            }
+        }
+        if (timedOut != 1000 || payment->refundCount() != 1000 || totalStock(*library) != (long long)(books * initialStock)) {
+            cerr << "timeout run: " << timedOut << " timed out, " << payment->refundCount() << " refunded" << endl;
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// FullUploadCloudStorage: Cloud storage without deltas, re-uploading the whole snapshot on every change
+class FullUploadCloudStorage : public FileStorageFromCloud {
+public:
+    using FileStorageFromCloud::FileStorageFromCloud;
+
+    void saveChanges(const vector<Book>& inventory, span<const size_t> changed, const string& filename) override {
+        saveToFile(inventory, filename);
+    }
+};
+
+// Sell random books through a Library backed by a directory object store and report the bytes
+// uploaded per sale, for delta sync and for whole-snapshot uploads; then reload the catalog from
+// the store into a fresh Library and check every quantity survived.
+// Usage: cloud_sync_bench [sales] [store directory]   (defaults: 2000 /tmp/cloud_sync_bench)
+int main(int argc, char* argv[]) {
+    size_t sales = argc > 1 ? stoull(argv[1]) : 2000;
+    string root = argc > 2 ? argv[2] : "/tmp/cloud_sync_bench";
+    bool ok = true;
+
+    cout << "variant,books,sales,ms,bytes_per_sale,requests_per_sale" << endl;
+    for (size_t books : {1000, 10000, 100000}) {
+        for (string variant : {"full", "delta", "delta-async"}) {
+            filesystem::remove_all(root);
+            auto store = make_shared<DirectoryObjectStore>(root);
+            unique_ptr<FileStorageBase> storage;
+            if (variant == "full") {
+                storage = make_unique<FullUploadCloudStorage>(store);
+            } else {
+                storage = make_unique<FileStorageFromCloud>(store);
+            }
+            vector<Book> catalog;
+            catalog.reserve(books);
+            for (size_t i = 0; i < books; i++) {
+                catalog.emplace_back("title " + to_string(i), "author " + to_string(i % 97), 100 + i % 400, 50);
+            }
+            FileStorageFromCloud(store).saveToFile(catalog, "catalog");  // Starting catalog in the store
+            auto library = make_unique<Library>(std::move(storage), "catalog");
+            library->loadInventory("catalog");
+            if (variant == "delta-async") {
+                library->enableAsyncPersistence(chrono::milliseconds(5));
+            }
+            // The full variant re-uploads everything per sale, so keep its run short on big catalogs
+            size_t runSales = variant == "full" ? min(sales, 2000000 / books) : sales;
+
+            uint64_t bytesBefore = store->bytesUploaded(), requestsBefore = store->requestCount();
+            mt19937 rng(7);
+            uniform_int_distribution<size_t> pick(0, books - 1);
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < runSales; i++) {
+                library->sellBookAt(pick(rng));
+            }
+            library->flush();
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            cout << variant << "," << books << "," << runSales << "," << ms << ","
+                 << double(store->bytesUploaded() - bytesBefore) / runSales << ","
+                 << double(store->requestCount() - requestsBefore) / runSales << endl;
+
+            // A second process would see the same catalog: snapshot plus deltas
+            vector<Book> reloaded = FileStorageFromCloud(store).loadFromFile("catalog");
+            const vector<Book>& current = library->getInventory();
+            bool same = reloaded.size() == current.size();
+            for (size_t i = 0; same && i < current.size(); i++) {
+                same = reloaded[i].getTitle() == current[i].getTitle() && reloaded[i].getQuantity() == current[i].getQuantity();
+            }
+            if (!same) {
+                cerr << variant << " with " << books << " books: reloaded catalog differs" << endl;
+                ok = false;
+            }
+        }
+    }
+    filesystem::remove_all(root);
+    return ok ? 0 : 1;
+}
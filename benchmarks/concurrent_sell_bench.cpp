@@ -0,0 +1,79 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <memory>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Stress one shared Library from 1..N threads mixing sales and restocks of random titles,
+// then check that every sale and restock is accounted for and that no title was oversold.
+// Usage: concurrent_sell_bench [max threads] [ops per thread]
+int main(int argc, char* argv[]) {
+    unsigned maxThreads = argc > 1 ? stoul(argv[1]) : max(4u, thread::hardware_concurrency());
+    size_t opsPerThread = argc > 2 ? stoull(argv[2]) : 500000;
+    const size_t books = 100000;
+    const int initialStock = 20;
+
+    cout << "threads,ops,ms,ops_per_sec,sold,restocked,out_of_stock" << endl;
+    bool ok = true;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        Library library(make_unique<NullStorage>());
+        vector<string> titles;
+        for (size_t i = 0; i < books; i++) {
+            titles.push_back("title " + to_string(i));
+            library.addBook(Book(titles.back(), "author", 100, initialStock));
+        }
+
+        atomic<long long> sold{0}, restocked{0}, outOfStock{0};
+        auto worker = [&](unsigned seed) {
+            mt19937 rng(seed);
+            // Skewed picks so that popular titles actually run out while others are restocked
+            uniform_int_distribution<size_t> pick(0, books / 10);
+            long long mySold = 0, myRestocked = 0, myOut = 0;
+            for (size_t i = 0; i < opsPerThread; i++) {
+                const string& title = titles[pick(rng)];
+                if (i % 16 == 0) {
+                    library.updateStock(title, 2);
+                    myRestocked += 2;
+                } else if (library.sellBook(title)) {
+                    mySold++;
+                } else {
+                    myOut++;
+                }
+            }
+            sold += mySold;
+            restocked += myRestocked;
+            outOfStock += myOut;
+        };
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back(worker, 1000 + t);
+        }
+        for (auto& th : pool) {
+            th.join();
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        long long finalStock = 0;
+        for (const auto& book : library.getInventory()) {
+            ok = ok && book.getQuantity() >= 0;
+            finalStock += book.getQuantity();
+        }
+        long long expected = (long long)books * initialStock + restocked - sold;
+        if (finalStock != expected) {
+            cerr << "stock mismatch with " << threads << " threads: " << finalStock << " != " << expected << endl;
+            ok = false;
+        }
+        size_t ops = threads * opsPerThread;
+        cout << threads << "," << ops << "," << ms << "," << ops / (ms / 1000) << ","
+             << sold << "," << restocked << "," << outOfStock << endl;
+    }
+    return ok ? 0 : 1;
+}
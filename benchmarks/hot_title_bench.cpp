@@ -0,0 +1,90 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "../hotstock.h"
+#include "../library.h"
+using namespace std;
+
+// Flash sale on one title: 1..64 threads sell it until it runs out, then keep trying for a while.
+// Variants: the Book's own atomic quantity, a HotStockCounter, and Library::reserveStock on the title
+// with and without setHotTitle. Reports sales/sec while stock lasts and the cost of an out-of-stock
+// attempt, and fails if any variant sells more or fewer copies than it had.
+// Usage: hot_title_bench [copies] [max threads] [shards]   (defaults: 2000000 64, one shard per hardware thread)
+int main(int argc, char* argv[]) {
+    int copies = argc > 1 ? stoi(argv[1]) : 2000000;
+    unsigned maxThreads = argc > 2 ? stoul(argv[2]) : 64;
+    size_t shards = argc > 3 ? stoull(argv[3]) : 0;
+    const int attemptsAfterSellout = 100000;
+    bool ok = true;
+
+    auto run = [&](const string& variant, unsigned threads, auto&& sell) {
+        atomic<long long> sold{0};
+        atomic<unsigned> ready{0};
+        atomic<bool> go{false};
+        vector<double> outOfStockNs(threads);
+        vector<chrono::steady_clock::time_point> soldOutAt(threads);
+        auto worker = [&](unsigned t) {
+            long long mine = 0;
+            ready++;
+            while (!go.load()) {
+                this_thread::yield();
+            }
+            while (sell()) {
+                mine++;
+            }
+            // Sold out: time the attempts that follow (any that succeed would be oversold copies)
+            auto start = soldOutAt[t] = chrono::steady_clock::now();
+            for (int i = 0; i < attemptsAfterSellout; i++) {
+                mine += sell();
+            }
+            outOfStockNs[t] = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / attemptsAfterSellout;
+            sold += mine;
+        };
+        vector<thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back(worker, t);
+        }
+        while (ready.load() < threads) {
+            this_thread::yield();
+        }
+        auto start = chrono::steady_clock::now();
+        go = true;
+        for (auto& th : pool) {
+            th.join();
+        }
+        double seconds = chrono::duration<double>(*max_element(soldOutAt.begin(), soldOutAt.end()) - start).count();
+        if (sold != copies) {
+            cerr << variant << " with " << threads << " threads sold " << sold << " of " << copies << " copies" << endl;
+            ok = false;
+        }
+        cout << "{\"bench\":\"hot_title\",\"variant\":\"" << variant << "\",\"threads\":" << threads
+             << ",\"copies\":" << copies << ",\"sold\":" << sold << ",\"sales_per_sec\":" << copies / seconds
+             << ",\"out_of_stock_ns\":" << *max_element(outOfStockNs.begin(), outOfStockNs.end()) << "}" << endl;
+    };
+
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        Book book("flash sale", "author", 100, copies);
+        run("book-atomic", threads, [&] { return book.tryTake(1); });
+
+        HotStockCounter counter(copies, shards);
+        run("hot-counter-" + to_string(counter.shardsUsed()), threads, [&] { return counter.tryTake(1); });
+
+        for (bool hot : {false, true}) {
+            Library library(make_unique<NullStorage>());
+            library.addBook(Book("flash sale", "author", 100, copies));
+            library.setHotTitle("flash sale", hot, shards);
+            size_t slot = *library.findBook("flash sale");
+            run(hot ? "library-hot" : "library", threads, [&] { return library.reserveStock(slot); });
+            if (library.getBook(slot).getQuantity() != 0) {
+                cerr << "library reports " << library.getBook(slot).getQuantity() << " copies left after the sellout" << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
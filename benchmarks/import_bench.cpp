@@ -0,0 +1,86 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Time a bulk import the way add_books_to_shelf --import runs it: load the inventory, merge a
+// delivery CSV by title, write the inventory once. Half of the delivery restocks known titles, the
+// other half brings new titles (each new title twice, so duplicates inside a delivery are exercised).
+// Then check every quantity and that no title was duplicated.
+// Usage: import_bench [inventory books] [delivery rows] [dir]   (defaults: 1000000 1000000 /tmp)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 1000000;
+    size_t rows = argc > 2 ? stoull(argv[2]) : 1000000;
+    string dir = argc > 3 ? argv[3] : "/tmp";
+    string inventoryFile = dir + "/import_bench_inventory.txt";
+    string deliveryFile = dir + "/import_bench_delivery.txt";
+    const int stock = 5, delivered = 3;
+
+    {
+        FileStorageFromFile writer;
+        vector<Book> inventory, delivery;
+        inventory.reserve(books);
+        for (size_t i = 0; i < books; i++) {
+            inventory.emplace_back("title " + to_string(i), "author " + to_string(i % 1000), 100 + i % 500, stock);
+        }
+        delivery.reserve(rows);
+        for (size_t i = 0; i < rows; i++) {
+            // Even rows restock title (i/2) % books; odd rows deliver new title (i/4), each one twice
+            string title = i % 2 == 0 ? "title " + to_string((i / 2) % books) : "new title " + to_string(i / 4);
+            delivery.emplace_back(title, "author " + to_string(i % 1000), 250, delivered);
+        }
+        writer.saveToFile(inventory, inventoryFile);
+        writer.saveToFile(delivery, deliveryFile);
+    }
+
+    auto elapsedMs = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    FileStorageFromFile loader(thread::hardware_concurrency());
+    auto start = chrono::steady_clock::now();
+    vector<Book> delivery = loader.loadFromFile(deliveryFile);
+    double readMs = elapsedMs(start);
+    auto loadStart = chrono::steady_clock::now();
+    Library library(make_unique<FileStorageFromFile>(), inventoryFile);
+    library.addBooks(loader.loadFromFile(inventoryFile));
+    double loadMs = elapsedMs(loadStart);
+    auto mergeStart = chrono::steady_clock::now();
+    MergeResult merged = library.mergeBooks(std::move(delivery));
+    double mergeMs = elapsedMs(mergeStart);
+    double totalMs = elapsedMs(start);
+
+    cout << "{\"bench\":\"import\",\"books\":" << books << ",\"rows\":" << rows
+         << ",\"read_delivery_ms\":" << readMs << ",\"load_inventory_ms\":" << loadMs
+         << ",\"merge_and_write_ms\":" << mergeMs << ",\"total_ms\":" << totalMs
+         << ",\"restocked\":" << merged.restocked << ",\"added\":" << merged.added << "}" << endl;
+
+    // Expected: known titles got delivered copies per even row that named them; new titles got two rows each
+    vector<int> expected(books, stock);
+    for (size_t i = 0; i < rows; i += 2) {
+        expected[(i / 2) % books] += delivered;
+    }
+    size_t newTitles = (rows + 2) / 4;
+    bool ok = library.getInventory().size() == books + newTitles && merged.added == newTitles;
+    for (size_t i = 0; ok && i < books; i++) {
+        ok = library.getInventory()[i].getQuantity() == expected[i];
+    }
+    for (size_t i = books; ok && i < library.getInventory().size(); i++) {
+        const Book& book = library.getInventory()[i];
+        size_t n = stoull(book.getTitle().substr(10));
+        int rowsForTitle = (4 * n + 1 < rows) + (4 * n + 3 < rows);
+        ok = book.getQuantity() == delivered * rowsForTitle;
+    }
+    ok = ok && FileStorageFromFile().loadFromFile(inventoryFile).size() == books + newTitles;
+    remove(inventoryFile.c_str());
+    remove(deliveryFile.c_str());
+    if (!ok) {
+        cerr << "merged inventory is wrong" << endl;
+        return 1;
+    }
+    return 0;
+}
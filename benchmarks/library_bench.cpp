@@ -0,0 +1,149 @@
+#include <iostream>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+#include "../journalstorage.h"
+#include "../binarystorage.h"
+#include "../customer.h"
+using namespace std;
+
+// Benchmark suite for the Library and FileStorage hot paths.
+// Prints one JSON object per line: bench, variant (storage backend), books, ops, ops_per_sec, p50/p99/max ns.
+// Usage: library_bench [--max-books N] [--template inventory.txt] [--dir /tmp]
+int main(int argc, char* argv[]) {
+    size_t maxBooks = 1000000;
+    string templateFile = "inventory.txt";
+    string dir = "/tmp";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--max-books") {
+            maxBooks = stoull(argv[i + 1]);
+        } else if (flag == "--template") {
+            templateFile = argv[i + 1];
+        } else if (flag == "--dir") {
+            dir = argv[i + 1];
+        } else {
+            cerr << "unknown flag: " << flag << endl;
+            return 1;
+        }
+    }
+    string csvFile = dir + "/library_bench_inventory.txt";
+    string binaryFile = dir + "/library_bench_inventory.bin";
+    string salesFile = dir + "/library_bench_sales.txt";
+
+    for (size_t books = 1000; books <= maxBooks; books *= 10) {
+        vector<Book> inventory = syntheticInventory(books, templateFile);
+        for (auto& book : inventory) {
+            book.setQuantity(1 << 30);  // Plenty of stock so every sale succeeds
+        }
+        vector<string> titles;
+        titles.reserve(books);
+        for (const auto& book : inventory) {
+            titles.push_back(book.getTitle());
+        }
+        mt19937 rng(7);
+        uniform_int_distribution<size_t> pick(0, books - 1);
+        size_t fileReps = books <= 100000 ? 5 : 2;
+        LatencyRecorder recorder;
+
+        // Whole-inventory storage operations, per backend
+        FileStorageFromFile csv;
+        FileStorageBinary binary;
+        for (size_t r = 0; r < fileReps; r++) {
+            recorder.measure([&] { csv.saveToFile(inventory, csvFile); });
+        }
+        recorder.report("saveToFile", books, "csv");
+        for (size_t r = 0; r < fileReps; r++) {
+            recorder.measure([&] { binary.saveToFile(inventory, binaryFile); });
+        }
+        recorder.report("saveToFile", books, "binary");
+        for (size_t r = 0; r < fileReps; r++) {
+            recorder.measure([&] { csv.loadFromFile(csvFile); });
+        }
+        recorder.report("loadFromFile", books, "csv");
+        for (size_t r = 0; r < fileReps; r++) {
+            recorder.measure([&] { binary.loadFromFile(binaryFile); });
+        }
+        recorder.report("loadFromFile", books, "binary");
+
+        // In-memory operations against a library that never writes
+        Library library(make_unique<NullStorage>());
+        for (const auto& book : inventory) {
+            library.addBook(book);
+        }
+        const size_t ops = 100000;
+        recorder.reserve(ops);
+        for (size_t i = 0; i < ops; i++) {
+            const string& title = titles[pick(rng)];
+            recorder.measure([&] { library.updateStock(title, 1); });
+        }
+        recorder.report("updateStock", books, "null");
+        for (size_t i = 0; i < ops; i++) {
+            const string& title = titles[pick(rng)];
+            recorder.measure([&] { library.sellBook(title); });
+        }
+        recorder.report("sellBook", books, "null");
+        {
+            Customer customer("bench", make_shared<CashPayment>());
+            {
+                CoutSilencer quiet;
+                for (size_t i = 0; i < ops; i++) {
+                    const string& title = titles[pick(rng)];
+                    recorder.measure([&] { customer.buyBook(library, title); });
+                }
+            }
+            recorder.report("buyBook", books, "null");
+        }
+        {
+            CoutSilencer quiet;
+            for (size_t r = 0; r < fileReps; r++) {
+                recorder.measure([&] { library.displayInventory(); });
+            }
+        }
+        recorder.report("displayInventory", books);
+        {
+            NullBuffer sink;
+            ostream out(&sink);
+            for (auto [variant, format] : {pair{"csv", ExportFormat::Csv}, pair{"jsonl", ExportFormat::JsonLines}}) {
+                for (size_t r = 0; r < fileReps; r++) {
+                    recorder.measure([&] { library.exportInventory(out, {.format = format}); });
+                }
+                recorder.report("exportInventory", books, variant);
+            }
+        }
+
+        // Sales that persist through a real backend. The CSV backend rewrites the whole file per sale,
+        // so it gets fewer operations.
+        for (string variant : {"csv", "journal", "journal-async"}) {
+            unique_ptr<FileStorageBase> storage;
+            if (variant == "csv") {
+                storage = make_unique<FileStorageFromFile>();
+            } else {
+                storage = make_unique<JournaledFileStorage>();
+            }
+            Library persisted(std::move(storage), salesFile);
+            for (const auto& book : inventory) {
+                persisted.addBook(book);
+            }
+            if (variant == "journal-async") {
+                persisted.enableAsyncPersistence();
+            }
+            size_t sales = variant == "csv" ? max<size_t>(5, 200000 / books) : ops;
+            for (size_t i = 0; i < sales; i++) {
+                const string& title = titles[pick(rng)];
+                recorder.measure([&] { persisted.sellBook(title); });
+            }
+            persisted.flush();
+            recorder.report("sellBook", books, variant);
+            remove(salesFile.c_str());
+            remove((salesFile + ".journal").c_str());
+        }
+    }
+    remove(csvFile.c_str());
+    remove(binaryFile.c_str());
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include "bench_util.h"
+#include "../filestorage.h"
+#include "../binarystorage.h"
+#include "../library.h"
+using namespace std;
+
+// Compare the iostream loader, the memory-mapped loader (sequential and on 1..N parser threads)
+// and the binary snapshot on a synthetic inventory, and check that they all load the same books.
+// Usage: load_bench [books] [template inventory] [max threads]   (defaults: 2000000 inventory.txt 8)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+    string templateFile = argc > 2 ? argv[2] : "inventory.txt";
+    size_t maxThreads = argc > 3 ? strtoull(argv[3], nullptr, 10) : max(8u, thread::hardware_concurrency());
+    string dataFile = "/tmp/load_bench_inventory.txt";
+    string binaryFile = "/tmp/load_bench_inventory.bin";
+
+    FileStorageFromFile storage;
+    vector<Book> rows = storage.loadFromFile(templateFile);
+    if (rows.empty()) {
+        cerr << "Template inventory is empty" << endl;
+        return 1;
+    }
+    vector<Book> inventory;
+    inventory.reserve(books);
+    for (size_t i = 0; i < books; i++) {
+        const Book& row = rows[i % rows.size()];
+        inventory.emplace_back(row.getTitle() + " " + to_string(i), row.getAuthor(), row.getPrice(), row.getQuantity());
+    }
+    storage.saveToFile(inventory, dataFile);
+    FileStorageBinary binaryStorage;
+    binaryStorage.saveToFile(inventory, binaryFile);
+    inventory.clear();
+    inventory.shrink_to_fit();
+
+    auto start = chrono::steady_clock::now();
+    vector<Book> streamed = storage.loadFromFileStream(dataFile);
+    double streamMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    vector<Book> mapped = storage.loadFromFile(dataFile);
+    double mappedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    vector<Book> binary = binaryStorage.loadFromFile(binaryFile);
+    double binaryMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    auto sameBooks = [](const vector<Book>& a, const vector<Book>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].getTitle() != b[i].getTitle() || a[i].getAuthor() != b[i].getAuthor()
+                || a[i].getPrice() != b[i].getPrice() || a[i].getQuantity() != b[i].getQuantity()) {
+                return false;
+            }
+        }
+        return true;
+    };
+    bool same = sameBooks(streamed, mapped) && sameBooks(streamed, binary);
+
+    cout << "loader,books,ms,books_per_sec" << endl;
+    cout << "stream," << streamed.size() << "," << streamMs << "," << streamed.size() / (streamMs / 1000) << endl;
+    cout << "mmap," << mapped.size() << "," << mappedMs << "," << mapped.size() / (mappedMs / 1000) << endl;
+    cout << "binary," << binary.size() << "," << binaryMs << "," << binary.size() / (binaryMs / 1000) << endl;
+    streamed = vector<Book>();
+    binary = vector<Book>();
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        FileStorageFromFile parallelStorage(threads);
+        start = chrono::steady_clock::now();
+        vector<Book> parallel = parallelStorage.loadFromFile(dataFile);
+        double parallelMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        same = same && sameBooks(mapped, parallel);
+        cout << "mmap-parallel-" << threads << "," << parallel.size() << "," << parallelMs << ","
+             << parallel.size() / (parallelMs / 1000) << endl;
+    }
+
+    // Whole reload into a Library: parallel parse, then one bulk insert
+    {
+        Library library(make_unique<FileStorageFromFile>(maxThreads), "/tmp/load_bench_saved.txt");
+        start = chrono::steady_clock::now();
+        library.loadInventory(dataFile);
+        double libraryMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        same = same && sameBooks(mapped, library.getInventory());
+        cout << "library-parallel-" << maxThreads << "," << library.getInventory().size() << "," << libraryMs << ","
+             << library.getInventory().size() / (libraryMs / 1000) << endl;
+        remove("/tmp/load_bench_saved.txt");
+    }
+    remove(dataFile.c_str());
+    remove(binaryFile.c_str());
+    if (!same) {
+        cerr << "Loaders disagree!" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Time sellBook and updateStock with metrics compiled in or out, to measure the instrumentation cost.
+// Build it twice and compare:
+//   g++ -std=c++20 -O2 -o metrics_off benchmarks/metrics_bench.cpp
+//   g++ -std=c++20 -O2 -DLMS_ENABLE_METRICS -o metrics_on benchmarks/metrics_bench.cpp
+// With metrics on, the collected snapshot is printed last.
+// Usage: metrics_bench [books] [ops]   (defaults: 100000 2000000)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 100000;
+    size_t ops = argc > 2 ? stoull(argv[2]) : 2000000;
+    const string variant = kMetricsEnabled ? "metrics-on" : "metrics-off";
+
+    Library library(make_unique<NullStorage>());
+    vector<string> titles;
+    for (size_t i = 0; i < books; i++) {
+        titles.push_back("title " + to_string(i));
+    }
+    vector<Book> catalog;
+    for (const auto& title : titles) {
+        catalog.emplace_back(title, "author", 100, 1000000);
+    }
+    library.addBooks(std::move(catalog));
+
+    mt19937 rng(3);
+    uniform_int_distribution<size_t> pick(0, books - 1);
+    vector<size_t> order(ops);
+    for (auto& i : order) {
+        i = pick(rng);
+    }
+    auto run = [&](const string& bench, auto&& op) {
+        auto start = chrono::steady_clock::now();
+        for (size_t i : order) {
+            op(i);
+        }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        cout << "{\"bench\":\"" << bench << "\",\"variant\":\"" << variant << "\",\"books\":" << books
+             << ",\"ops\":" << ops << ",\"ns_per_op\":" << ns / ops << "}" << endl;
+    };
+    run("sellBook", [&](size_t i) { library.sellBook(titles[i]); });
+    run("updateStock", [&](size_t i) { library.updateStock(titles[i], 1); });
+    run("sellBook-miss", [&](size_t i) { library.sellBook("missing " + to_string(i)); });
+    Metrics::dump(cout);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Range queries in order: "books priced 300-500 with stock" and "titles by authors a-c", answered by
+// a scan of the inventory plus a sort (today's way) and by Library::forEachInPriceRange and
+// forEachByAuthorRange over the ordered indexes. Also times the first page (20 results) of the price
+// query, where the index stops early. Books are then added one at a time and sold out, and the
+// queries are checked again, so the indexes' unsorted tails and live stock are covered too.
+// Prints one JSON line per catalog size and query; fails if the index and the scan disagree.
+// Usage: range_index_bench [max books]   (default 1000000; sizes go 1M, 10M, ... up to max)
+int main(int argc, char* argv[]) {
+    size_t maxBooks = argc > 1 ? stoull(argv[1]) : 1000000;
+    const double lowPrice = 300, highPrice = 500;
+    const size_t page = 20;
+
+    auto elapsedMs = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    bool ok = true;
+    for (size_t books = min<size_t>(1000000, maxBooks); books <= maxBooks; books *= 10) {
+        mt19937 rng(24);
+        Library library(make_unique<NullStorage>());
+        {
+            vector<Book> inventory;
+            inventory.reserve(books);
+            size_t authors = max<size_t>(books / 8, 1);
+            for (size_t i = 0; i < books; i++) {
+                size_t author = rng() % authors;
+                char initial = static_cast<char>((author % 2 ? 'a' : 'A') + author % 26);
+                inventory.push_back(Book::fromCents("title " + to_string(i), string(1, initial) + "-author " + to_string(author),
+                                                    10000 + rng() % 90000, rng() % 4 == 0 ? 0 : 1 + rng() % 20));
+            }
+            library.addBooks(std::move(inventory));
+        }
+        const vector<Book>& inventory = library.getInventory();
+        long long lowCents = llround(lowPrice * 100), highCents = llround(highPrice * 100);
+
+        // Today's way: scan every book, keep the matches, sort them
+        auto scanPrice = [&](size_t limit) {
+            vector<size_t> slots;
+            for (size_t slot = 0; slot < inventory.size(); slot++) {
+                const Book& book = inventory[slot];
+                if (book.getPriceCents() >= lowCents && book.getPriceCents() <= highCents && book.getQuantity() > 0) {
+                    slots.push_back(slot);
+                }
+            }
+            auto byPrice = [&](size_t a, size_t b) {
+                return inventory[a].getPriceCents() != inventory[b].getPriceCents() ? inventory[a].getPriceCents() < inventory[b].getPriceCents() : a < b;
+            };
+            if (limit < slots.size()) {
+                partial_sort(slots.begin(), slots.begin() + limit, slots.end(), byPrice);
+                slots.resize(limit);
+            } else {
+                sort(slots.begin(), slots.end(), byPrice);
+            }
+            return slots;
+        };
+        auto scanAuthors = [&] {
+            vector<pair<string, size_t>> matches;
+            for (size_t slot = 0; slot < inventory.size(); slot++) {
+                string author = SearchIndex::normalize(inventory[slot].getAuthor());
+                if (author >= "a" && author.compare(0, 1, "c") <= 0) {
+                    matches.emplace_back(std::move(author), slot);
+                }
+            }
+            sort(matches.begin(), matches.end());
+            vector<size_t> slots;
+            slots.reserve(matches.size());
+            for (const auto& match : matches) {
+                slots.push_back(match.second);
+            }
+            return slots;
+        };
+        auto indexPrice = [&](size_t limit) {
+            vector<size_t> slots;
+            library.forEachInPriceRange(lowPrice, highPrice, [&](size_t slot, const Book& book) {
+                if (book.getQuantity() > 0) {
+                    slots.push_back(slot);
+                }
+                return slots.size() < limit;
+            });
+            return slots;
+        };
+        auto indexAuthors = [&] {
+            vector<size_t> slots;
+            library.forEachByAuthorRange("a", "c", [&](size_t slot, const Book&) {
+                slots.push_back(slot);
+                return true;
+            });
+            return slots;
+        };
+
+        // Time each query both ways (best of three) and compare the answers
+        auto compare = [&](const string& query, auto scan, auto index) {
+            vector<size_t> scanned, indexed;
+            double scanMs = 1e300, indexMs = 1e300;
+            for (int round = 0; round < 3; round++) {
+                auto start = chrono::steady_clock::now();
+                scanned = scan();
+                scanMs = min(scanMs, elapsedMs(start));
+                start = chrono::steady_clock::now();
+                indexed = index();
+                indexMs = min(indexMs, elapsedMs(start));
+            }
+            ok = ok && scanned == indexed;
+            cout << "{\"bench\":\"range_index\",\"books\":" << books << ",\"query\":\"" << query << "\",\"results\":"
+                 << indexed.size() << ",\"scan_sort_ms\":" << scanMs << ",\"index_ms\":" << indexMs << "}" << endl;
+        };
+        auto runAll = [&](const string& suffix) {
+            compare("price_in_stock" + suffix, [&] { return scanPrice(SIZE_MAX); }, [&] { return indexPrice(SIZE_MAX); });
+            compare("price_first_page" + suffix, [&] { return scanPrice(page); }, [&] { return indexPrice(page); });
+            compare("authors_a_to_c" + suffix, scanAuthors, indexAuthors);
+        };
+        runAll("");
+
+        // Add books one at a time (they land in the indexes' tails) and sell some titles out
+        for (size_t i = 0; i < 5000; i++) {
+            library.addBook(Book::fromCents("late title " + to_string(i), "B-late author " + to_string(i % 1500), 30000 + rng() % 20001, 1));
+        }
+        for (size_t i = 0; i < 5000; i++) {
+            size_t slot = rng() % inventory.size();
+            while (library.sellBookAt(slot)) {
+            }
+        }
+        runAll("_after_updates");
+    }
+
+    if (!ok) {
+        cerr << "index range queries differ from scan and sort" << endl;
+        return 1;
+    }
+    return 0;
+}
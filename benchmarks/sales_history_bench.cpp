@@ -0,0 +1,163 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+#include "../saleshistory.h"
+using namespace std;
+
+// Record a week of skewed sales across a large catalog into a SalesHistory file, then run hourly
+// queries for single titles, an author's titles and the whole store. The expected hourly totals are
+// counted while the sales are generated; the queries must match them, both on the live history and
+// after reloading it from the file. Reports sales recorded per second, bytes per sale on disk and
+// the time per query. Ends with a small check of Library::enableSalesHistory.
+// Usage: sales_history_bench [sales] [titles]   (defaults: 20000000 100000)
+int main(int argc, char* argv[]) {
+    size_t sales = argc > 1 ? stoull(argv[1]) : 20000000;
+    uint32_t titles = argc > 2 ? uint32_t(stoul(argv[2])) : 100000;
+    const string file = "/tmp/sales_history_bench.bin";
+    const int64_t weekStart = 1700000000, hour = 3600, hours = 7 * 24;
+    const uint32_t authors = 1000;  // Title t is by author t % authors
+    const uint32_t author = 7;
+    remove(file.c_str());
+
+    // Expected hourly totals: a few single titles (the best seller, mid-list and tail titles), one
+    // author and the whole store
+    vector<uint32_t> sampleTitles = {0, 17, titles / 20, titles / 2, titles - 1};
+    vector<vector<SalesTotals>> expectedTitle(sampleTitles.size(), vector<SalesTotals>(hours));
+    vector<SalesTotals> expectedAuthor(hours), expectedStore(hours);
+    auto count = [&](vector<SalesTotals>& buckets, int64_t time, int64_t price, uint32_t units) {
+        SalesTotals& bucket = buckets[size_t((time - weekStart) / hour)];
+        bucket.units += units;
+        bucket.revenueCents += price * units;
+    };
+
+    auto elapsedMs = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    mt19937 rng(23);
+    uniform_real_distribution<double> unit(0, 1);
+    double recordMs = 0, storedBytes = 0;
+    auto history = make_unique<SalesHistory>(file);
+    {
+        // Generate in chunks so the timing covers record() only
+        const size_t chunk = 1 << 16;
+        struct Sale {
+            uint32_t title;
+            uint32_t units;
+            int64_t time;
+            int64_t price;
+        };
+        vector<Sale> pending;
+        pending.reserve(chunk);
+        for (size_t done = 0; done < sales;) {
+            pending.clear();
+            for (; pending.size() < chunk && done < sales; done++) {
+                double u = unit(rng);
+                Sale sale;
+                sale.title = min(titles - 1, uint32_t(titles * u * u * u));
+                sale.time = weekStart + int64_t(done * (hours * hour) / sales);
+                sale.price = 500 + (sale.title % 50) * 100;
+                if (rng() % 200 == 0) {
+                    sale.price -= sale.price / 5;  // Occasional discount
+                }
+                sale.units = rng() % 20 == 0 ? 2 + rng() % 3 : 1;
+                pending.push_back(sale);
+                count(expectedStore, sale.time, sale.price, sale.units);
+                if (sale.title % authors == author) {
+                    count(expectedAuthor, sale.time, sale.price, sale.units);
+                }
+                for (size_t i = 0; i < sampleTitles.size(); i++) {
+                    if (sale.title == sampleTitles[i]) {
+                        count(expectedTitle[i], sale.time, sale.price, sale.units);
+                    }
+                }
+            }
+            auto start = chrono::steady_clock::now();
+            for (const auto& sale : pending) {
+                history->record(sale.title, sale.time, sale.price, sale.units);
+            }
+            recordMs += elapsedMs(start);
+        }
+        auto start = chrono::steady_clock::now();
+        history->flush();
+        recordMs += elapsedMs(start);
+        storedBytes = double(history->storedBytes());
+    }
+
+    vector<uint32_t> authorTitles;
+    for (uint32_t t = author; t < titles; t += authors) {
+        authorTitles.push_back(t);
+    }
+    auto same = [](const vector<SalesTotals>& a, const vector<SalesTotals>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].units != b[i].units || a[i].revenueCents != b[i].revenueCents) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // Run every query on a history, check it, and time each kind
+    double titleMs = 0, authorMs = 0, storeMs = 0, dayMs = 0;
+    auto check = [&](const SalesHistory& history) {
+        bool ok = history.eventCount() == sales;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < sampleTitles.size(); i++) {
+            ok = ok && same(history.histogram(weekStart, weekStart + hours * hour, hour, span<const uint32_t>(&sampleTitles[i], 1)), expectedTitle[i]);
+        }
+        titleMs = elapsedMs(start) / sampleTitles.size();
+        start = chrono::steady_clock::now();
+        ok = ok && same(history.histogram(weekStart, weekStart + hours * hour, hour, authorTitles), expectedAuthor);
+        authorMs = elapsedMs(start);
+        start = chrono::steady_clock::now();
+        ok = ok && same(history.histogram(weekStart, weekStart + hours * hour, hour), expectedStore);
+        storeMs = elapsedMs(start);
+        // One day out of the middle of the week only decodes the blocks that overlap it
+        start = chrono::steady_clock::now();
+        vector<SalesTotals> day(expectedStore.begin() + 72, expectedStore.begin() + 96);
+        ok = ok && same(history.histogram(weekStart + 72 * hour, weekStart + 96 * hour, hour), day);
+        dayMs = elapsedMs(start);
+        return ok;
+    };
+
+    bool ok = check(*history);
+    history.reset();
+    double loadMs;
+    {
+        auto start = chrono::steady_clock::now();
+        SalesHistory reloaded(file);
+        loadMs = elapsedMs(start);
+        ok = check(reloaded) && ok;
+    }
+
+    // Library integration: sales through the library land in its history at the book's price
+    Library library(make_unique<NullStorage>());
+    library.addBook(Book("history title", "history author", 12.5, 10));
+    library.addBook(Book("other title", "history author", 4, 10));
+    library.enableSalesHistory();
+    library.sellBookAt(0);
+    library.sellBookAt(0);
+    library.sellBookAt(1);
+    int64_t now = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+    vector<SalesTotals> title = library.titleSales("history title", now - 60, now + 60, 120);
+    vector<SalesTotals> byAuthor = library.authorSales("History Author", now - 60, now + 60, 120);
+    ok = ok && title.size() == 1 && title[0].units == 2 && title[0].revenueCents == 2500;
+    ok = ok && byAuthor.size() == 1 && byAuthor[0].units == 3 && byAuthor[0].revenueCents == 2900;
+
+    cout << "{\"bench\":\"sales_history\",\"sales\":" << sales << ",\"titles\":" << titles
+         << ",\"record_per_sec\":" << sales / (recordMs / 1000) << ",\"bytes_per_sale\":" << storedBytes / sales
+         << ",\"load_ms\":" << loadMs << ",\"title_hourly_ms\":" << titleMs << ",\"author_hourly_ms\":" << authorMs
+         << ",\"store_hourly_ms\":" << storeMs << ",\"store_one_day_ms\":" << dayMs << "}" << endl;
+    remove(file.c_str());
+    if (!ok) {
+        cerr << "sales history queries differ from the recorded sales" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Time title-prefix, author and keyword queries on a large synthetic catalog.
+// Usage: search_bench [books] [template inventory]   (defaults: 1000000 inventory.txt)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 1000000;
+    vector<Book> inventory = syntheticInventory(books, argc > 2 ? argv[2] : "inventory.txt");
+
+    Library library(make_unique<NullStorage>());
+    LatencyRecorder recorder;
+    recorder.measure([&] {
+        for (const auto& book : inventory) {
+            library.addBook(book);
+        }
+    });
+    recorder.report("addBook-all", books, "incremental");
+
+    mt19937 rng(11);
+    uniform_int_distribution<size_t> pick(0, books - 1);
+    const size_t queries = 20000;
+    size_t hits = 0;
+    recorder.reserve(queries);
+    for (size_t i = 0; i < queries; i++) {
+        string title = inventory[pick(rng)].getTitle();
+        string prefix = title.substr(0, min<size_t>(title.size(), 5 + i % 8));
+        recorder.measure([&] { hits += library.findByTitlePrefix(prefix, 20).size(); });
+    }
+    recorder.report("findByTitlePrefix", books);
+    for (size_t i = 0; i < queries; i++) {
+        string author = inventory[pick(rng)].getAuthor();
+        recorder.measure([&] { hits += library.findByAuthor(author).size(); });
+    }
+    recorder.report("findByAuthor", books);
+    for (size_t i = 0; i < queries; i++) {
+        // First title word plus the author's last name: common words intersected with a narrower list
+        const Book& book = inventory[pick(rng)];
+        string title = book.getTitle(), author = book.getAuthor();
+        string query = title.substr(0, title.find(' ')) + " " + author.substr(author.rfind(' ') + 1);
+        recorder.measure([&] { hits += library.searchKeywords(query, 20).size(); });
+    }
+    recorder.report("searchKeywords", books);
+    if (hits == 0) {
+        cerr << "no query matched anything" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "../libraryserver.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+// One client connection keeping a fixed number of requests in flight
+struct ClientConnection {
+    int fd = -1;
+    string input;   // Received bytes not yet split into responses
+    string output;  // Requests not yet accepted by the socket
+    deque<Clock::time_point> sentAt;  // Send time of each outstanding request, oldest first
+};
+
+static int connectTo(const string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    return fd;
+}
+
+// Drive a LibraryServer with pipelined requests from many connections and report requests/sec and
+// latency percentiles (from sending a request to reading its response) as one JSON line.
+// The mix is 70% LOOKUP, 20% BUY, 5% RESTOCK and 5% SEARCH on titles from the inventory file.
+// With --inproc N the server runs in this process over N synthetic books, so no setup is needed.
+// Usage: server_loadgen [--socket /tmp/library.sock] [--connections 16] [--depth 16] [--seconds 5]
+//                       [--inventory inventory.txt] [--inproc books]
+int main(int argc, char* argv[]) {
+    string socketPath = "/tmp/library.sock", inventoryFile = "inventory.txt";
+    size_t connectionCount = 16, depth = 16, inproc = 0;
+    double seconds = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--socket") {
+            socketPath = argv[i + 1];
+        } else if (flag == "--connections") {
+            connectionCount = stoull(argv[i + 1]);
+        } else if (flag == "--depth") {
+            depth = stoull(argv[i + 1]);
+        } else if (flag == "--seconds") {
+            seconds = stod(argv[i + 1]);
+        } else if (flag == "--inventory") {
+            inventoryFile = argv[i + 1];
+        } else if (flag == "--inproc") {
+            inproc = stoull(argv[i + 1]);
+        }
+    }
+
+    vector<Book> catalog = inproc > 0 ? syntheticInventory(inproc, inventoryFile) : FileStorageFromFile().loadFromFile(inventoryFile);
+    if (catalog.empty()) {
+        cerr << "No titles to request" << endl;
+        return 1;
+    }
+    vector<string> titles, words;
+    for (const auto& book : catalog) {
+        titles.push_back(book.getTitle());
+        words.push_back(book.getTitle().substr(0, book.getTitle().find(' ')));
+    }
+
+    // Optional in-process server
+    unique_ptr<Library> library;
+    unique_ptr<LibraryServer> server;
+    thread serverThread;
+    if (inproc > 0) {
+        library = make_unique<Library>(make_unique<NullStorage>());
+        library->addBooks(std::move(catalog));
+        server = make_unique<LibraryServer>(*library, socketPath);
+        if (!server->start()) {
+            return 1;
+        }
+        serverThread = thread([&] { server->run(); });
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    vector<ClientConnection> connections(connectionCount);
+    for (size_t c = 0; c < connectionCount; c++) {
+        connections[c].fd = connectTo(socketPath);
+        if (connections[c].fd < 0) {
+            cerr << "Cannot connect to " << socketPath << endl;
+            return 1;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = c;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, connections[c].fd, &event);
+    }
+
+    mt19937 rng(17);
+    uniform_int_distribution<size_t> pickTitle(0, titles.size() - 1);
+    uniform_int_distribution<int> pickKind(0, 99);
+    auto queueRequest = [&](ClientConnection& connection) {
+        int kind = pickKind(rng);
+        const string& title = titles[pickTitle(rng)];
+        if (kind < 70) {
+            connection.output += "LOOKUP " + title + "\n";
+        } else if (kind < 90) {
+            connection.output += "BUY " + title + "\n";
+        } else if (kind < 95) {
+            connection.output += "RESTOCK 2 " + title + "\n";
+        } else {
+            connection.output += "SEARCH " + words[pickTitle(rng)] + "\n";
+        }
+        connection.sentAt.push_back(Clock::now());
+    };
+    auto flush = [&](size_t c) {
+        ClientConnection& connection = connections[c];
+        while (!connection.output.empty()) {
+            ssize_t n = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            connection.output.erase(0, static_cast<size_t>(n));
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | (connection.output.empty() ? 0 : EPOLLOUT);
+        event.data.u64 = c;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    };
+
+    vector<double> latencies;
+    size_t errors = 0, outstanding = 0;
+    auto start = Clock::now();
+    auto deadline = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+    for (size_t c = 0; c < connectionCount; c++) {
+        for (size_t d = 0; d < depth; d++) {
+            queueRequest(connections[c]);
+            outstanding++;
+        }
+        flush(c);
+    }
+
+    vector<epoll_event> events(connectionCount);
+    char buffer[1 << 16];
+    while (outstanding > 0) {
+        int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 1000);
+        if (ready <= 0) {
+            if (ready == 0) {
+                cerr << "Server stopped answering" << endl;
+                return 1;
+            }
+            continue;
+        }
+        bool sending = Clock::now() < deadline;
+        for (int e = 0; e < ready; e++) {
+            size_t c = events[e].data.u64;
+            ClientConnection& connection = connections[c];
+            ssize_t n;
+            while ((n = read(connection.fd, buffer, sizeof(buffer))) > 0) {
+                connection.input.append(buffer, static_cast<size_t>(n));
+            }
+            size_t consumed = 0, end;
+            auto now = Clock::now();
+            while ((end = connection.input.find('\n', consumed)) != string::npos) {
+                errors += connection.input.compare(consumed, 3, "ERR") == 0;
+                consumed = end + 1;
+                latencies.push_back(chrono::duration<double, nano>(now - connection.sentAt.front()).count());
+                connection.sentAt.pop_front();
+                outstanding--;
+                if (sending) {
+                    queueRequest(connection);
+                    outstanding++;
+                }
+            }
+            connection.input.erase(0, consumed);
+            flush(c);
+        }
+    }
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+    cout << "{\"bench\":\"server\",\"connections\":" << connectionCount << ",\"depth\":" << depth
+         << ",\"requests\":" << latencies.size() << ",\"errors\":" << errors
+         << ",\"requests_per_sec\":" << latencies.size() / elapsed
+         << ",\"p50_ns\":" << percentile(0.50) << ",\"p99_ns\":" << percentile(0.99)
+         << ",\"p999_ns\":" << percentile(0.999) << ",\"max_ns\":" << latencies.back() << "}" << endl;
+
+    for (auto& connection : connections) {
+        close(connection.fd);
+    }
+    close(epollFd);
+    if (server) {
+        server->stop();
+        serverThread.join();
+    }
+    return 0;
+}
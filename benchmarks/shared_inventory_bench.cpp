@@ -0,0 +1,141 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "../sharedinventory.h"
+using namespace std;
+
+// Multi-process stress test for SharedInventory. The parent creates a segment; each child process
+// attaches to it, sells and restocks random titles (skewed, so a few titles run out and are fought
+// over), and one child also adds new books while the others look them up and sell them. Children
+// report what they did through a pipe. The parent then checks that no sale or restock was lost, no
+// title went negative, and a save by the persistence owner reloads to the same stock.
+// Also compares attaching to the segment with loading the inventory file.
+// Usage: shared_inventory_bench [books] [processes] [ops per process]   (defaults: 100000 8 200000)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 100000;
+    int processes = argc > 2 ? stoi(argv[2]) : 8;
+    size_t opsPerProcess = argc > 3 ? stoull(argv[3]) : 200000;
+    const size_t added = 2000;
+    const string name = "/lms-shared-bench-" + to_string(getpid());
+    const string file = "/tmp/shared_inventory_bench.txt";
+
+    vector<Book> inventory = syntheticInventory(books);
+    FileStorageFromFile storage;
+    storage.saveToFile(inventory, file);
+    long long initialStock = 0;
+    for (const auto& book : inventory) {
+        initialStock += book.getQuantity();
+    }
+
+    auto start = chrono::steady_clock::now();
+    auto segment = SharedInventory::create(name, books + added + 1024, 64 << 20, storage.loadFromFile(file));
+    double createMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (!segment) {
+        return 1;
+    }
+
+    // Each child writes: sold, restocked, adds (one line of three numbers)
+    int results[2];
+    if (pipe(results) != 0) {
+        return 1;
+    }
+    start = chrono::steady_clock::now();
+    for (int p = 0; p < processes; p++) {
+        if (fork() == 0) {
+            close(results[0]);
+            auto attachStart = chrono::steady_clock::now();
+            auto shared = SharedInventory::attach(name);
+            double attachUs = chrono::duration<double, micro>(chrono::steady_clock::now() - attachStart).count();
+            if (!shared) {
+                _exit(1);
+            }
+            mt19937 rng(500 + p);
+            uniform_real_distribution<double> unit(0, 1);
+            long long sold = 0, restocked = 0, adds = 0;
+            for (size_t i = 0; i < opsPerProcess; i++) {
+                double u = unit(rng);
+                if (p == 0 && i % (opsPerProcess / added) == 0 && adds < (long long)added) {
+                    shared->addBook(Book("added " + to_string(adds), "author", 100, 3));
+                    adds++;
+                } else if (i % 10 == 0) {
+                    // Restock a title that was added at runtime when there is one, otherwise a hot one
+                    string title = u < 0.5 && shared->size() > books ? "added " + to_string(rng() % (shared->size() - books))
+                                                                      : inventory[size_t(books * u * u * u)].getTitle();
+                    restocked += shared->updateStock(title, 2) ? 2 : 0;
+                } else {
+                    sold += shared->sellBookAt(min(books - 1, size_t(books * u * u * u)));
+                }
+            }
+            string line = to_string(sold) + " " + to_string(restocked) + " " + to_string(adds) + " " + to_string(attachUs) + "\n";
+            ssize_t ignored = write(results[1], line.data(), line.size());
+            (void)ignored;
+            _exit(0);
+        }
+    }
+    close(results[1]);
+    bool ok = true;
+    for (int p = 0; p < processes; p++) {
+        int status = 0;
+        wait(&status);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    double runMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    long long sold = 0, restocked = 0, adds = 0;
+    double maxAttachUs = 0;
+    FILE* report = fdopen(results[0], "r");
+    long long s, r, a;
+    double us;
+    while (fscanf(report, "%lld %lld %lld %lf", &s, &r, &a, &us) == 4) {
+        sold += s;
+        restocked += r;
+        adds += a;
+        maxAttachUs = max(maxAttachUs, us);
+    }
+    fclose(report);
+
+    long long finalStock = 0;
+    for (size_t slot = 0; slot < segment->size(); slot++) {
+        int quantity = segment->quantity(slot);
+        ok = ok && quantity >= 0;
+        finalStock += quantity;
+    }
+    long long expected = initialStock + 3 * adds + restocked - sold;
+    if (finalStock != expected || segment->size() != books + adds) {
+        cerr << "lost updates: stock " << finalStock << ", expected " << expected << "; books " << segment->size()
+             << ", expected " << books + adds << endl;
+        ok = false;
+    }
+
+    // The persistence owner saves everyone's changes; a reload must see exactly the shared stock
+    ok = ok && segment->claimPersistence() && segment->saveIfChanged(storage, file);
+    long long reloaded = 0;
+    for (const auto& book : storage.loadFromFile(file)) {
+        reloaded += book.getQuantity();
+    }
+    ok = ok && reloaded == finalStock;
+
+    start = chrono::steady_clock::now();
+    size_t loadedBooks = storage.loadFromFile(file).size();
+    double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    size_t ops = processes * opsPerProcess;
+    cout << "{\"bench\":\"shared_inventory\",\"books\":" << books << ",\"processes\":" << processes
+         << ",\"ops\":" << ops << ",\"ops_per_sec\":" << ops / (runMs / 1000) << ",\"sold\":" << sold
+         << ",\"restocked\":" << restocked << ",\"added\":" << adds << ",\"create_ms\":" << createMs
+         << ",\"attach_us_max\":" << maxAttachUs << ",\"load_file_ms\":" << loadMs
+         << ",\"loaded_books\":" << loadedBooks << "}" << endl;
+
+    SharedInventory::remove(name);
+    remove(file.c_str());
+    if (!ok) {
+        cerr << "shared inventory stress test failed" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Run a sales storm on one Library, first alone and then with a reporter taking snapshots and exporting
+// the whole inventory back to back, and compare writer throughput. Writers sell odd slots, move stock
+// between even slots with two-line batches, and now and then add a book (which can move the inventory
+// vector under a live reference). Every snapshot must see the even slots' total unchanged (no batch
+// half-applied) and the odd slots' total never rising; at the end every sale and move must be accounted for.
+// Snapshots do not block writers, so with fewer cores than threads the throughput lost is about the
+// reporter's own share of the CPU, which is reported alongside.
+// Usage: snapshot_bench [books] [writer threads] [seconds per run]   (defaults: 200000 4 2)
+int main(int argc, char* argv[]) {
+    size_t books = argc > 1 ? stoull(argv[1]) : 200000;
+    unsigned writers = argc > 2 ? stoul(argv[2]) : 4;
+    double seconds = argc > 3 ? stod(argv[3]) : 2;
+    const int initialStock = 1000;
+    bool ok = true;
+    double baseline = 0;
+
+    for (bool reports : {false, true}) {
+        Library library(make_unique<NullStorage>());
+        vector<Book> inventory;
+        vector<string> titles;
+        for (size_t i = 0; i < books; i++) {
+            titles.push_back("title " + to_string(i));
+            inventory.emplace_back(titles.back(), "author " + to_string(i % 1000), 100 + i % 50, initialStock);
+        }
+        library.addBooks(std::move(inventory));
+        long long evenTotal = (long long)((books + 1) / 2) * initialStock;
+
+        atomic<bool> stop{false};
+        atomic<size_t> totalOps{0};
+        vector<vector<int>> changes(writers, vector<int>(books));  // Per writer: net change applied to each slot
+        auto writer = [&](unsigned id) {
+            mt19937 rng(100 + id);
+            uniform_int_distribution<size_t> pick(0, books - 1);
+            vector<int>& mine = changes[id];
+            size_t ops = 0;
+            for (; !stop.load(memory_order_relaxed); ops++) {
+                size_t slot = pick(rng);
+                if (ops % 4096 == 4095) {
+                    library.addBook(Book("added " + to_string(id) + " " + to_string(ops), "author", 100, 0));
+                } else if (slot % 2 == 1) {
+                    mine[slot] -= library.sellBookAt(slot);
+                } else {
+                    size_t to = pick(rng) & ~size_t(1);
+                    if (to != slot && library.applyBatch({{titles[slot], -1}, {titles[to], 1}}).applied) {
+                        mine[slot]--;
+                        mine[to]++;
+                    }
+                }
+            }
+            totalOps += ops;
+        };
+
+        size_t snapshots = 0, exported = 0;
+        double reporterCpuSeconds = 0;
+        vector<double> snapshotUs;
+        auto reporter = [&] {
+            long long lastOddTotal = LLONG_MAX;
+            NullBuffer sink;
+            ostream out(&sink);
+            while (!stop.load(memory_order_relaxed)) {
+                auto start = chrono::steady_clock::now();
+                auto view = library.snapshot();
+                snapshotUs.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+                long long even = 0, odd = 0;
+                for (size_t slot = 0; slot < books; slot++) {
+                    (slot % 2 == 0 ? even : odd) += view->quantity(slot);
+                }
+                if (even != evenTotal || odd > lastOddTotal) {
+                    cerr << "inconsistent snapshot: even total " << even << " (expected " << evenTotal
+                         << "), odd total " << odd << " after " << lastOddTotal << endl;
+                    ok = false;
+                }
+                lastOddTotal = odd;
+                snapshots++;
+                exported += library.exportInventory(out, {ExportFormat::Csv});
+            }
+            timespec cpu{};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+            reporterCpuSeconds = cpu.tv_sec + cpu.tv_nsec / 1e9;
+        };
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (unsigned t = 0; t < writers; t++) {
+            pool.emplace_back(writer, t);
+        }
+        thread reportThread;
+        if (reports) {
+            reportThread = thread(reporter);
+        }
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+        stop = true;
+        for (auto& th : pool) {
+            th.join();
+        }
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (reports) {
+            reportThread.join();
+        }
+
+        // No lost updates: each slot ends at its initial stock plus every change the writers saw succeed
+        auto final = library.snapshot();
+        for (size_t slot = 0; slot < books; slot++) {
+            int expected = initialStock;
+            for (const auto& mine : changes) {
+                expected += mine[slot];
+            }
+            if (final->quantity(slot) != expected || library.getBook(slot).getQuantity() != expected) {
+                cerr << "slot " << slot << " has " << final->quantity(slot) << " copies, expected " << expected << endl;
+                ok = false;
+                break;
+            }
+        }
+
+        double opsPerSec = totalOps / elapsed;
+        if (!reports) {
+            baseline = opsPerSec;
+        }
+        sort(snapshotUs.begin(), snapshotUs.end());
+        auto percentile = [&](double p) { return snapshotUs.empty() ? 0 : snapshotUs[min(snapshotUs.size() - 1, size_t(p * snapshotUs.size()))]; };
+        cout << "{\"bench\":\"snapshot\",\"variant\":\"" << (reports ? "with-reports" : "writers-only") << "\""
+             << ",\"books\":" << books << ",\"writers\":" << writers << ",\"writer_ops_per_sec\":" << opsPerSec
+             << ",\"vs_writers_only\":" << opsPerSec / baseline << ",\"snapshots\":" << snapshots
+             << ",\"exported_books\":" << exported << ",\"snapshot_p50_us\":" << percentile(0.5)
+             << ",\"snapshot_max_us\":" << percentile(1.0) << ",\"reporter_cpu_share\":" << reporterCpuSeconds / elapsed
+             << ",\"books_at_end\":" << final->size() << "}" << endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <memory>
+#include "bench_util.h"
+#include "../library.h"
+using namespace std;
+
+// Time title lookups against libraries of growing size.
+// With the title index the cost per lookup should stay flat from 1k to 1M books.
+int main() {
+    const size_t probes = 1000000;
+    cout << "books,ns_per_lookup,ns_per_update" << endl;
+    for (size_t books : {1000, 10000, 100000, 1000000}) {
+        Library library(make_unique<NullStorage>());
+        vector<string> titles;
+        titles.reserve(books);
+        for (size_t i = 0; i < books; i++) {
+            titles.push_back("title " + to_string(i));
+            library.addBook(Book(titles.back(), "author " + to_string(i % 997), 100 + i % 500, 10));
+        }
+
+        mt19937 rng(42);
+        uniform_int_distribution<size_t> pick(0, books - 1);
+        vector<size_t> order(probes);
+        for (auto& i : order) {
+            i = pick(rng);
+        }
+
+        size_t found = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i : order) {
+            found += library.findBook(titles[i]).has_value();
+        }
+        auto lookupNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        for (size_t i : order) {
+            library.updateStock(titles[i], 1);
+        }
+        auto updateNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        if (found != probes) {
+            cerr << "lookup missed " << probes - found << " titles" << endl;
+            return 1;
+        }
+        cout << books << "," << lookupNs / probes << "," << updateNs / probes << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+#ifndef BINARYSTORAGE_H
+#define BINARYSTORAGE_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include "filestorage.h"
+#include "mappedfile.h"
+
+// Binary inventory snapshot layout (native little-endian, every section 8-byte aligned):
+//
+//   BinarySnapshotHeader                      32 bytes
+//   double   price[count]                     fixed-width price column
+//   int32_t  quantity[count]                  fixed-width quantity column (padded to 8 bytes)
+//   uint64_t titleOffset[count + 1]           title i is heap[titleOffset[i], titleOffset[i + 1])
+//   uint64_t authorOffset[count + 1]          author i is heap[authorOffset[i], authorOffset[i + 1])
+//   char     heap[heapSize]                   all title and author bytes
+//
+// The checksum (snapshotChecksum) covers everything after the header, section by section.
+struct BinarySnapshotHeader {
+    char magic[4];  // "LMSB"
+    uint32_t version;  // Format version, currently 1
+    uint64_t count;  // Number of books
+    uint64_t heapSize;  // Bytes in the string heap
+    uint64_t checksum;  // snapshotChecksum of the body
+};
+
+inline constexpr char kBinarySnapshotMagic[4] = {'L', 'M', 'S', 'B'};
+inline constexpr uint32_t kBinarySnapshotVersion = 1;
+
+// Snapshot checksum: FNV-1a style mixing over 64-bit words (byte-wise for the tail),
+// continuing from a previous value. Word-at-a-time keeps verification far below load time.
+inline uint64_t snapshotChecksum(const char* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const uint64_t prime = 1099511628211ull;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+// BinarySnapshotView Class: Zero-copy view over a mapped binary snapshot
+// Numeric columns are read straight from the mapping and strings are handed out as string_views,
+// so nothing is materialized until the caller asks for a Book.
+class BinarySnapshotView {
+public:
+    explicit BinarySnapshotView(const string& filename) : file(filename) {
+        string_view data = file.data();
+        Metrics::count(Counter::BytesRead, data.size());
+        if (data.size() < sizeof(BinarySnapshotHeader)) {
+            return;
+        }
+        BinarySnapshotHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+        if (memcmp(header.magic, kBinarySnapshotMagic, 4) != 0 || header.version != kBinarySnapshotVersion) {
+            return;
+        }
+        uint64_t n = header.count;
+        if (n > data.size() / (sizeof(double) + sizeof(int32_t) + 2 * sizeof(uint64_t)) || header.heapSize > data.size()) {
+            return;  // Sizes that cannot fit the file (and would overflow the arithmetic below)
+        }
+        size_t quantityBytes = (n * sizeof(int32_t) + 7) & ~size_t(7);
+        size_t expected = sizeof(header) + n * sizeof(double) + quantityBytes
+            + 2 * (n + 1) * sizeof(uint64_t) + header.heapSize;
+        if (data.size() != expected) {
+            return;
+        }
+        const char* body = data.data() + sizeof(header);
+        if (snapshotChecksum(body, data.size() - sizeof(header)) != header.checksum) {
+            return;
+        }
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(body + n * sizeof(double) + quantityBytes);
+        if (!offsetsValid(offsets, n, header.heapSize) || !offsetsValid(offsets + n + 1, n, header.heapSize)) {
+            return;
+        }
+        count = n;
+        prices = reinterpret_cast<const double*>(body);
+        quantities = reinterpret_cast<const int32_t*>(body + n * sizeof(double));
+        titleOffsets = offsets;
+        authorOffsets = titleOffsets + n + 1;
+        heap = reinterpret_cast<const char*>(authorOffsets + n + 1);
+        valid = true;
+    }
+
+    // Whether the file exists and passed the header, checksum and offset checks
+    bool isValid() const { return valid; }
+
+    size_t size() const { return count; }
+    string_view title(size_t i) const { return string_view(heap + titleOffsets[i], titleOffsets[i + 1] - titleOffsets[i]); }
+    string_view author(size_t i) const { return string_view(heap + authorOffsets[i], authorOffsets[i + 1] - authorOffsets[i]); }
+    double price(size_t i) const { return prices[i]; }
+    int quantity(size_t i) const { return quantities[i]; }
+
+    // Materialize one record
+    Book book(size_t i) const { return Book(string(title(i)), author(i), price(i), quantity(i)); }
+
+private:
+    // A string offsets table is usable if it never decreases and stays inside the heap; the checksum
+    // only proves the file is what the writer wrote, not that the writer was sane
+    static bool offsetsValid(const uint64_t* offsets, uint64_t n, uint64_t heapSize) {
+        for (uint64_t i = 0; i < n; i++) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        }
+        return offsets[n] <= heapSize;
+    }
+
+    MappedFile file;  // Keeps the mapping alive for the views below
+    bool valid = false;
+    size_t count = 0;
+    const double* prices = nullptr;
+    const int32_t* quantities = nullptr;
+    const uint64_t* titleOffsets = nullptr;
+    const uint64_t* authorOffsets = nullptr;
+    const char* heap = nullptr;
+};
+
+// FileStorageBinary Class: Stores the inventory as a versioned binary columnar snapshot
+// Extends FileStorageBase; loading is a mapping plus one pass to build Books, with no text parsing.
+class FileStorageBinary : public FileStorageBase {
+public:
+    // Save the inventory as a binary snapshot (written to a temp file, then renamed into place)
+    void saveToFile(const vector<Book>& inventory, const string& filename) override {
+        uint64_t n = inventory.size();
+        size_t quantityBytes = (n * sizeof(int32_t) + 7) & ~size_t(7);
+        vector<double> prices(n);
+        vector<int32_t> quantities(quantityBytes / sizeof(int32_t));
+        vector<uint64_t> offsets(2 * (n + 1));
+        string heap;
+        uint64_t* titleOffsets = offsets.data();
+        uint64_t* authorOffsets = offsets.data() + n + 1;
+        for (size_t i = 0; i < n; i++) {
+            prices[i] = inventory[i].getPrice();
+            quantities[i] = inventory[i].getQuantity();
+            titleOffsets[i] = heap.size();
+            heap += inventory[i].getTitle();
+        }
+        titleOffsets[n] = heap.size();
+        for (size_t i = 0; i < n; i++) {
+            authorOffsets[i] = heap.size();
+            heap += inventory[i].getAuthor();
+        }
+        authorOffsets[n] = heap.size();
+
+        BinarySnapshotHeader header;
+        memcpy(header.magic, kBinarySnapshotMagic, 4);
+        header.version = kBinarySnapshotVersion;
+        header.count = n;
+        header.heapSize = heap.size();
+        uint64_t hash = snapshotChecksum(reinterpret_cast<const char*>(prices.data()), n * sizeof(double));
+        hash = snapshotChecksum(reinterpret_cast<const char*>(quantities.data()), quantityBytes, hash);
+        hash = snapshotChecksum(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t), hash);
+        header.checksum = snapshotChecksum(heap.data(), heap.size(), hash);
+
+        string tempName = filename + ".tmp";
+        ofstream file(tempName, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cerr << "Error opening file!" << endl;
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(prices.data()), n * sizeof(double));
+        file.write(reinterpret_cast<const char*>(quantities.data()), quantityBytes);
+        file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        file.write(heap.data(), heap.size());
+        Metrics::count(Counter::BytesWritten, sizeof(header) + n * sizeof(double) + quantityBytes
+            + offsets.size() * sizeof(uint64_t) + heap.size());
+        file.close();
+        if (!file || rename(tempName.c_str(), filename.c_str()) != 0) {
+            cerr << "Error writing binary snapshot!" << endl;
+        }
+    }
+
+    // Load inventory data from a binary snapshot
+    vector<Book> loadFromFile(const string& filename) override {
+        vector<Book> inventory;
+        tryLoad(filename, inventory);
+        return inventory;
+    }
+
+    // Load like loadFromFile, but return false if the file is missing or fails its checks
+    bool tryLoad(const string& filename, vector<Book>& inventory) {
+        inventory.clear();
+        BinarySnapshotView view(filename);
+        if (!view.isValid()) {
+            cerr << "Error opening binary snapshot!" << endl;
+            return false;
+        }
+        inventory.reserve(view.size());
+        for (size_t i = 0; i < view.size(); i++) {
+            inventory.push_back(view.book(i));
+        }
+        return true;
+    }
+};
+
+#endif // BINARYSTORAGE_H
@@ -2,34 +2,84 @@
 #define BOOK_H
 
 #include <string>  // Include only necessary headers
+#include <utility>
+#include <atomic>
+#include <cmath>
+#include <string_view>
+#include "stringpool.h"
 using namespace std;
 // Book Class: Adheres to the Single Responsibility Principle (SRP)
 // The Book class is responsible only for holding and managing book-related data.
 class Book {
 public:
-    Book(const string& title, const string& author, double price, int quantity)
-        : title(title), author(author), price(price), quantity(quantity) {}
+    // The title is taken by value so callers can move a freshly parsed string in without a second copy.
+    // Authors repeat across the catalog, so they are interned in StringPool::authors() and shared.
+    // Prices are stored as whole cents.
+    Book(string title, string_view author, double price, int quantity)
+        : title(std::move(title)), author(&StringPool::authors().intern(author)),
+          priceCents(llround(price * 100)), quantity(quantity) {}
+
+    // Build a book from a price already in cents (no floating-point rounding)
+    static Book fromCents(string title, string_view author, long long priceCents, int quantity) {
+        Book book(std::move(title), author, 0, quantity);
+        book.priceCents = priceCents;
+        return book;
+    }
+
+    // Copies read the quantity atomically, so a Book can be copied while another thread sells it
+    Book(const Book& other) : title(other.title), author(other.author), priceCents(other.priceCents), quantity(other.getQuantity()) {}
+    Book& operator=(const Book& other) {
+        title = other.title;
+        author = other.author;
+        priceCents = other.priceCents;
+        quantity = other.getQuantity();
+        return *this;
+    }
+    Book(Book&&) = default;
+    Book& operator=(Book&&) = default;
 
     // Getter for the book title
-    string getTitle() const { return title; }
+    const string& getTitle() const { return title; }
 
     // Getter for the book author
-    string getAuthor() const { return author; }
+    const string& getAuthor() const { return *author; }
 
     // Getter for the book price
-    double getPrice() const { return price; }
+    double getPrice() const { return priceCents / 100.0; }
+
+    // Getter for the book price in cents
+    long long getPriceCents() const { return priceCents; }
 
     // Getter for the book quantity
-    int getQuantity() const { return quantity; }
+    // Quantity is accessed atomically so sales on different threads can share a Book.
+    int getQuantity() const { return stock().load(memory_order_relaxed); }
 
     // Setter to update the quantity of the book
-    void setQuantity(int qty) { quantity = qty; }
+    void setQuantity(int qty) { stock().store(qty, memory_order_relaxed); }
+
+    // Atomically add to the quantity and return the new value
+    int addQuantity(int delta) { return stock().fetch_add(delta, memory_order_relaxed) + delta; }
+
+    // Atomically take count copies if that many are in stock; never lets the quantity go negative
+    bool tryTake(int count) {
+        auto counter = stock();
+        int current = counter.load(memory_order_relaxed);
+        while (current >= count) {
+            if (counter.compare_exchange_weak(current, current - count, memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
 private:
-    string title;   // Book title
-    string author;  // Book author
-    double price;   // Book price
-    int quantity;   // Book quantity
+    // Per-record atomic view of the quantity (Books stay plain copyable values)
+    atomic_ref<int> stock() const { return atomic_ref<int>(const_cast<int&>(quantity)); }
+
+    string title;          // Book title
+    const string* author;  // Book author (interned, shared with other books)
+    long long priceCents;  // Book price in cents
+    int quantity;          // Book quantity
 };
 
 #endif // BOOK_H
@@ -0,0 +1,151 @@
+#ifndef CHECKOUT_H
+#define CHECKOUT_H
+
+#include <string>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include "library.h"
+#include "payment.h"
+#include "threadpool.h"
+using namespace std;
+
+// Outcome of one checkout
+enum class CheckoutStatus {
+    Completed,   // Paid and sold
+    NotFound,    // No book with that title
+    OutOfStock,  // No copy could be reserved
+    Declined,    // Payment declined; the reserved copy went back to stock
+    TimedOut,    // No payment answer in time; the copy went back, a late approval is refunded
+};
+
+// CheckoutPipeline Class: Keeps many single-book checkouts in flight against one Library
+// Each checkout reserves a copy, starts the payment asynchronously and returns. When the payment
+// answers, a pool thread commits the sale or releases the copy; if no answer comes within the
+// timeout the copy is released and a later approval is refunded. Pool threads never wait on a
+// payment, so throughput is bounded by the pool and storage, not by payment latency.
+class CheckoutPipeline {
+public:
+    CheckoutPipeline(Library& library, size_t threads = 4, chrono::milliseconds timeout = chrono::seconds(10))
+        : library(library), timeout(timeout), pool(threads) {}
+
+    // Waits until every checkout has started and had its payment answered, so no callback outlives the pipeline
+    ~CheckoutPipeline() {
+        unique_lock lock(mutex_);
+        idle.wait(lock, [&] { return inFlight == 0; });
+    }
+
+    CheckoutPipeline(const CheckoutPipeline&) = delete;
+    CheckoutPipeline& operator=(const CheckoutPipeline&) = delete;
+
+    // Start a checkout of one copy of title paid with payment; the future resolves when it ends
+    future<CheckoutStatus> checkout(string title, shared_ptr<Payment> payment) {
+        auto state = make_shared<Checkout>();
+        state->title = std::move(title);
+        state->payment = std::move(payment);
+        future<CheckoutStatus> result = state->result.get_future();
+        {
+            lock_guard lock(mutex_);
+            inFlight++;
+        }
+        pool.post([this, state] { start(state); });
+        return result;
+    }
+
+    // Checkout timeouts still queued; a checkout's timeout is dropped as soon as its payment answers
+    size_t pendingTimeouts() { return timers.pending(); }
+
+private:
+    struct Checkout {
+        string title;
+        shared_ptr<Payment> payment;
+        size_t slot = 0;
+        double price = 0;
+        chrono::steady_clock::time_point paymentStart;
+        TimerQueue::TimerId timeoutTimer;  // Cancelled when the payment answers first
+        atomic<bool> settled{false};  // Set by whichever of payment answer and timeout comes first
+        promise<CheckoutStatus> result;
+    };
+
+    // Reserve a copy and start the payment (pool thread)
+    void start(const shared_ptr<Checkout>& state) {
+        auto slot = library.findBook(state->title);
+        if (!slot) {
+            state->result.set_value(CheckoutStatus::NotFound);
+            checkoutDone();
+            return;
+        }
+        if (!library.reserveStock(*slot)) {
+            state->result.set_value(CheckoutStatus::OutOfStock);
+            checkoutDone();
+            return;
+        }
+        state->slot = *slot;
+        state->price = library.readBook(*slot, [](const Book& book) { return book.getPrice(); });
+        state->timeoutTimer = timers.scheduleAfter(timeout, [this, state] {
+            if (!state->settled.exchange(true)) {
+                pool.post([this, state] {
+                    library.releaseReservation(state->slot);
+                    state->result.set_value(CheckoutStatus::TimedOut);
+                });
+            }
+        });
+        if constexpr (kMetricsEnabled) {
+            state->paymentStart = chrono::steady_clock::now();
+        }
+        state->payment->processPaymentAsync(state->price, [this, state](bool approved) {
+            if constexpr (kMetricsEnabled) {
+                auto waited = chrono::steady_clock::now() - state->paymentStart;
+                Metrics::recordLatency(Operation::Payment, chrono::duration_cast<chrono::nanoseconds>(waited).count());
+            }
+            // Finish on the pool: the answer may arrive on the provider's thread, and saving the sale
+            // may block on storage
+            pool.post([this, state, approved] {
+                finish(state, approved);
+                checkoutDone();
+            });
+        });
+    }
+
+    // Act on the payment answer (pool thread)
+    void finish(const shared_ptr<Checkout>& state, bool approved) {
+        if (state->settled.exchange(true)) {
+            // Already timed out and released; don't keep money for a book we no longer hold
+            if (approved) {
+                state->payment->refundPayment(state->price);
+            }
+            return;
+        }
+        // The timeout holds the checkout, so drop it now rather than keep every finished checkout
+        // queued for the whole timeout
+        timers.cancel(state->timeoutTimer);
+        if (approved) {
+            library.commitReservation(state->slot);
+            state->result.set_value(CheckoutStatus::Completed);
+        } else {
+            library.releaseReservation(state->slot);
+            state->result.set_value(CheckoutStatus::Declined);
+        }
+    }
+
+    // Called once per checkout when nothing about it can run any more, except a queued timeout release
+    void checkoutDone() {
+        lock_guard lock(mutex_);
+        if (--inFlight == 0) {
+            idle.notify_all();
+        }
+    }
+
+    Library& library;
+    chrono::milliseconds timeout;  // Longest a checkout waits for its payment
+    mutex mutex_;
+    condition_variable idle;  // Signals the destructor when no checkout is in flight
+    size_t inFlight = 0;  // Checkouts submitted whose payment answer has not been handled yet
+    ThreadPool pool;  // Runs reservations and completions
+    TimerQueue timers;  // Fires checkout timeouts; declared last so it stops (firing early) first
+};
+
+#endif // CHECKOUT_H
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include "filestorage.h"
+#include "binarystorage.h"
+#include "inventorylock.h"
+#include "sharedinventory.h"
+using namespace std;
+
+// Convert an inventory between the CSV and the binary snapshot formats.
+// Usage: convert_inventory to-binary inventory.txt inventory.bin
+//        convert_inventory to-csv inventory.bin inventory.txt
+int main(int argc, char* argv[])
+{
+    if (argc != 4) {
+        cerr << "usage: " << argv[0] << " <to-binary|to-csv> <input> <output>" << endl;
+        return 1;
+    }
+    string mode = argv[1];
+    vector<Book> inventory;
+    unique_ptr<FileStorageBase> writer;
+    bool loaded = false;
+    if (mode == "to-binary") {
+        loaded = FileStorageFromFile().tryLoad(argv[2], inventory);
+        writer = make_unique<FileStorageBinary>();
+    } else if (mode == "to-csv") {
+        loaded = FileStorageBinary().tryLoad(argv[2], inventory);
+        writer = make_unique<FileStorageFromFile>();
+    } else {
+        cerr << "unknown mode: " << mode << endl;
+        return 1;
+    }
+    // Never replace the output with an empty inventory because the input was unreadable
+    if (!loaded) {
+        cerr << "cannot read " << argv[2] << "; " << argv[3] << " left unchanged" << endl;
+        return 1;
+    }
+
+    // Do not replace an inventory that the server or a terminal is writing
+    InventoryLock lock(argv[3], InventoryLock::Mode::Exclusive);
+    if (!lock.held() || SharedInventory::terminalSegmentBlocks()) {
+        return 1;
+    }
+    writer->saveToFile(inventory, argv[3]);
+    cout << "converted " << inventory.size() << " books" << endl;
+    return 0;
+}
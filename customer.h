@@ -0,0 +1,75 @@
+#ifndef CUSTOMER_H
+#define CUSTOMER_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "library.h"
+#include "payment.h"
+#include "checkout.h"
+using namespace std;
+
+// Customer Class: Manages customer interactions with the library
+class Customer {
+public:
+    // Constructor to initialize customer with a payment method
+    Customer(const string& name, shared_ptr<Payment> paymentMethod) : name(name), paymentMethod(paymentMethod) {}
+
+    // Buy a book from the library
+    bool buyBook(Library& library, const string& title) {
+        // Resolve the title once; reservation, payment and sale all work on the same slot
+        auto slot = library.findBook(title);
+        if (!slot) {
+            cout << "Book not found in inventory!" << endl;
+            return false;
+        }
+        // Hold a copy before charging, so a paid customer can never find the book sold out
+        if (!library.reserveStock(*slot)) {
+            cout << "Book out of stock!" << endl;
+            return false;
+        }
+        double price = library.readBook(*slot, [](const Book& book) { return book.getPrice(); });
+        if (!pay(price)) {
+            library.releaseReservation(*slot);
+            return false;
+        }
+        library.commitReservation(*slot);
+        cout << name << " bought " << title << endl;
+        return true;
+    }
+
+    // Buy a book through a checkout pipeline without waiting for the payment provider.
+    // The future resolves once the payment has answered (or timed out) and the sale is settled.
+    future<CheckoutStatus> buyBookAsync(CheckoutPipeline& pipeline, const string& title) {
+        return pipeline.checkout(title, paymentMethod);
+    }
+
+    // Check out a whole cart: every title is sold or none is, and storage is written once.
+    // The copies are held while the payment runs and only count as sold once it goes through.
+    bool checkoutCart(Library& library, const vector<string>& titles) {
+        BatchReservation cart = library.reserveBatch(titles);
+        if (!cart.reserved) {
+            cout << "Some books in the cart are missing or out of stock!" << endl;
+            return false;
+        }
+        if (!pay(cart.saleTotal)) {
+            library.releaseBatch(cart);  // Put the stock back if the payment is declined
+            return false;
+        }
+        library.commitBatch(cart);
+        cout << name << " bought " << titles.size() << " books" << endl;
+        return true;
+    }
+
+private:
+    bool pay(double amount) {
+        ScopedLatency timer(Operation::Payment);
+        return paymentMethod->processPayment(amount);
+    }
+
+    string name;  // Customer name
+    shared_ptr<Payment> paymentMethod;  // Payment method
+};
+
+#endif // CUSTOMER_H
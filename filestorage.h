@@ -7,7 +7,19 @@
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <span>
+#include <algorithm>
+#include <iterator>
+#include <future>
+#include <charconv>
+#include <string_view>
+#include <unordered_map>
 #include"book.h"
+#include "mappedfile.h"
+#include "threadpool.h"
+#include "metrics.h"
+#include "objectstore.h"
+#include "inventoryexport.h"
 using namespace std;
 
 // FileStorageBase Class: Adheres to the Open/Closed Principle (OCP)
@@ -16,6 +28,13 @@ class FileStorageBase {
 public:
     virtual void saveToFile(const vector<Book>& inventory, const string& filename) = 0;  // Save inventory to a file
     virtual vector<Book> loadFromFile(const string& filename) = 0;  // Load inventory from a file
+
+    // Persist a change to a few inventory slots.
+    // Storage that cannot record individual changes falls back to rewriting the whole inventory.
+    virtual void saveChanges(const vector<Book>& inventory, span<const size_t> changed, const string& filename) {
+        saveToFile(inventory, filename);
+    }
+
     virtual ~FileStorageBase() = default;  // Virtual destructor
 };
 
@@ -23,6 +42,9 @@ public:
 // Extends FileStorageBase for local file-based storage.
 class FileStorageFromFile : public FileStorageBase {
 public:
+    // loadThreads > 1 makes loadFromFile parse the file on that many worker threads
+    explicit FileStorageFromFile(size_t loadThreads = 1) : loadThreads(loadThreads) {}
+
     // Save the inventory to a file (overwrites existing data)
     void saveToFile(const vector<Book>& inventory, const string& filename) override {
         ofstream file(filename);
@@ -35,11 +57,87 @@ public:
             file << ++id << "," << book.getTitle() << "," << book.getAuthor() << ","
                  << book.getPrice() << "," << book.getQuantity() << "\n";
         }
+        if constexpr (kMetricsEnabled) {
+            Metrics::count(Counter::BytesWritten, static_cast<uint64_t>(file.tellp()));
+        }
         file.close();
     }
 
     // Load inventory data from a file
+    // The file is memory-mapped and parsed in place; each Book allocates at most its title.
     vector<Book> loadFromFile(const string& filename) override {
+        vector<Book> inventory;
+        tryLoad(filename, inventory);
+        return inventory;
+    }
+
+    // Load like loadFromFile, but return false if the file cannot be opened (an empty file is fine)
+    bool tryLoad(const string& filename, vector<Book>& inventory) {
+        inventory.clear();
+        MappedFile file(filename);
+        if (!file.isOpen()) {
+            cerr << "Error opening file!" << endl;
+            return false;
+        }
+        string_view data = file.data();
+        Metrics::count(Counter::BytesRead, data.size());
+        if (loadThreads > 1) {
+            inventory = parseParallel(data, loadThreads);
+            return true;
+        }
+        inventory.reserve(count(data.begin(), data.end(), '\n') + 1);
+        parseLines(data, inventory);
+        return true;
+    }
+
+    // Parse a whole file image on a pool of threads. The data is cut into newline-aligned chunks
+    // (a few per thread, so uneven chunks even out), each parsed into its own vector, and the
+    // pieces are joined in file order, so the result is identical to a sequential parse.
+    static vector<Book> parseParallel(string_view data, size_t threads) {
+        size_t chunks = threads * 4;
+        size_t target = max<size_t>(data.size() / chunks, 1 << 16);
+        vector<string_view> pieces;
+        while (!data.empty()) {
+            size_t end = min(target, data.size());
+            end = data.find('\n', end - 1);
+            end = end == string_view::npos ? data.size() : end + 1;
+            pieces.push_back(data.substr(0, end));
+            data.remove_prefix(end);
+        }
+
+        vector<vector<Book>> parsed(pieces.size());
+        {
+            ThreadPool pool(threads);
+            vector<future<void>> done;
+            for (size_t i = 0; i < pieces.size(); i++) {
+                done.push_back(pool.submit([&parsed, &pieces, i] {
+                    parsed[i].reserve(count(pieces[i].begin(), pieces[i].end(), '\n') + 1);
+                    parseLines(pieces[i], parsed[i]);
+                }));
+            }
+            for (auto& piece : done) {
+                piece.get();
+            }
+        }
+
+        if (parsed.size() == 1) {
+            return std::move(parsed[0]);
+        }
+        size_t total = 0;
+        for (const auto& piece : parsed) {
+            total += piece.size();
+        }
+        vector<Book> inventory;
+        inventory.reserve(total);
+        for (auto& piece : parsed) {
+            move(piece.begin(), piece.end(), back_inserter(inventory));
+            vector<Book>().swap(piece);  // Release each piece as soon as it is merged
+        }
+        return inventory;
+    }
+
+    // Load inventory data through iostreams (the original loader, kept for comparison benchmarks)
+    vector<Book> loadFromFileStream(const string& filename) {
         vector<Book> inventory;
         ifstream file(filename);
         if (!file.is_open()) {
@@ -63,23 +161,286 @@ public:
         file.close();
         return inventory;
     }
+
+    // Parse "ID,Title,Author,Price,Quantity" lines from an in-memory buffer and append the books
+    static void parseLines(string_view data, vector<Book>& inventory) {
+        while (!data.empty()) {
+            size_t end = data.find('\n');
+            string_view line = data.substr(0, end);
+            data.remove_prefix(end == string_view::npos ? data.size() : end + 1);
+            if (line.find_first_not_of(" \t\r") == string_view::npos) {
+                continue;  // Skip blank lines
+            }
+            nextField(line);  // The ID column is the row position, so it is not stored
+            string_view title = nextField(line);
+            string_view author = nextField(line);
+            double price = 0;
+            int quantity = 0;
+            line = parseNumber(line, price);
+            if (!line.empty()) {
+                line.remove_prefix(1);  // Skip the comma
+            }
+            parseNumber(line, quantity);
+            inventory.emplace_back(string(title), author, price, quantity);  // Authors are interned, not copied
+        }
+    }
+
+private:
+    // Split off the text up to the next comma (or the rest of the line)
+    static string_view nextField(string_view& line) {
+        size_t comma = line.find(',');
+        string_view field = line.substr(0, comma);
+        line.remove_prefix(comma == string_view::npos ? line.size() : comma + 1);
+        return field;
+    }
+
+    // Parse a number after optional blanks (like operator>>) and return what follows it
+    template <typename T>
+    static string_view parseNumber(string_view text, T& value) {
+        size_t start = text.find_first_not_of(" \t");
+        if (start == string_view::npos) {
+            return {};
+        }
+        auto [ptr, ec] = from_chars(text.data() + start, text.data() + text.size(), value);
+        return text.substr(ptr - text.data());
+    }
+
+    size_t loadThreads;  // Parser threads used by loadFromFile
 };
 
-// FileStorageFromCloud Class: Simulates cloud-based storage
-// Extends FileStorageBase for cloud storage operations.
+// FileStorageFromCloud Class: Keeps the inventory in a remote object store
+// Under "<filename>/" it stores CSV snapshots numbered by generation, a manifest naming the current
+// generation and the first delta that applies to it, and numbered delta objects of "title,quantity"
+// records. saveChanges uploads one delta holding only the changed books, so a sale moves a few dozen
+// bytes whatever the catalog size; with Library::enableAsyncPersistence the dirty books of many sales
+// go up together in one delta. Once the deltas add up to the size of the snapshot, a new generation
+// is written and the snapshot and deltas it replaces are deleted; snapshot uploads therefore cost at
+// most as much as the deltas themselves.
+// Snapshots and delta keys are claimed with create-only puts and the manifest with version-checked
+// puts. A writer that finds a delta or manifest it did not write has missed another writer's changes,
+// so it stops saving (and says so) until the inventory is loaded again; writers sharing a store never
+// silently overwrite each other.
 class FileStorageFromCloud : public FileStorageBase {
 public:
-    // Simulate saving inventory to the cloud
+    explicit FileStorageFromCloud(shared_ptr<ObjectStore> store) : store(std::move(store)) {}
+
+    // Upload a full snapshot as a new generation and make it the base for later deltas (this is also
+    // the compaction step). The previous snapshot and the deltas folded in are only deleted once the
+    // manifest names the new one.
     void saveToFile(const vector<Book>& inventory, const string& filename) override {
-        cout << "[Cloud] Saving to cloud..." << endl;
+        bind(filename);
+        if (stale) {
+            cerr << "[Cloud] Store was changed by another writer; reload before saving" << endl;
+            return;
+        }
+        if (hasForeignDeltas(filename)) {
+            return;
+        }
+        ostringstream snapshot;
+        {
+            InventoryExporter exporter(snapshot, ExportFormat::Csv);
+            for (size_t slot = 0; slot < inventory.size(); slot++) {
+                exporter.write(slot, inventory[slot]);
+            }
+        }
+        uint64_t newGeneration = generation + 1;
+        if (!store->put(snapshotKey(filename, newGeneration), snapshot.view(), ObjectStore::kMissing)) {
+            cerr << "[Cloud] Error uploading snapshot (another writer may have claimed it); reload before saving" << endl;
+            stale = true;
+            return;
+        }
+        // Deltas already uploaded are reflected in the snapshot; later ones start at nextDelta
+        string manifest = to_string(nextDelta) + " " + to_string(snapshot.view().size()) + " " + to_string(newGeneration) + "\n";
+        auto version = store->put(manifestKey(filename), manifest, manifestVersion);
+        if (!version) {
+            cerr << "[Cloud] Manifest was changed by another writer; reload before saving" << endl;
+            store->remove(snapshotKey(filename, newGeneration));
+            stale = true;
+            return;
+        }
+        manifestVersion = *version;
+        store->remove(snapshotKey(filename, generation));
+        generation = newGeneration;
+        firstDelta = nextDelta;
+        snapshotBytes = snapshot.view().size();
+        deltaBytes = 0;
+        for (const auto& key : store->list(deltaPrefix(filename))) {
+            if (deltaNumber(filename, key) < nextDelta) {
+                store->remove(key);
+            } else if (!stale) {
+                // Another writer's delta landed while we compacted and now applies over our snapshot
+                cerr << "[Cloud] Another writer saved changes; reload before saving" << endl;
+                stale = true;
+            }
+        }
+    }
+
+    // Upload the changed books as one delta object
+    void saveChanges(const vector<Book>& inventory, span<const size_t> changed, const string& filename) override {
+        bind(filename);
+        if (stale) {
+            cerr << "[Cloud] Store was changed by another writer; reload before saving" << endl;
+            return;
+        }
+        string delta;
+        for (size_t slot : changed) {
+            const Book& book = inventory[slot];
+            delta += book.getTitle();
+            delta += ',';
+            delta += to_string(book.getQuantity());
+            delta += '\n';
+        }
+        // Records hold absolute quantities, so a delta written over another writer's changes would
+        // undo them: if the number is taken or the manifest moved on, take the delta back and stop
+        if (!store->put(deltaKey(filename, nextDelta), delta, ObjectStore::kMissing)) {
+            cerr << "[Cloud] Another writer saved changes; reload before saving" << endl;
+            stale = true;
+            return;
+        }
+        auto manifest = store->get(manifestKey(filename));
+        if ((manifest ? manifest->version : ObjectStore::kMissing) != manifestVersion) {
+            cerr << "[Cloud] Manifest was changed by another writer; reload before saving" << endl;
+            store->remove(deltaKey(filename, nextDelta));
+            stale = true;
+            return;
+        }
+        nextDelta++;
+        deltaBytes += delta.size();
+        if (deltaBytes >= max(snapshotBytes, kMinCompactBytes)) {
+            saveToFile(inventory, filename);
+        }
     }
 
-    // Simulate loading inventory from the cloud
+    // Download the snapshot and apply the deltas written since it
     vector<Book> loadFromFile(const string& filename) override {
-        cout << "[Cloud] Loading data from cloud..." << endl;
-        return {};  // Returning empty inventory for simulation
+        // A writer compacting meanwhile may delete the snapshot the manifest named; read again then
+        for (int attempt = 0; attempt < 8; attempt++) {
+            boundFile.clear();
+            bind(filename);
+            vector<Book> inventory;
+            auto snapshot = store->get(snapshotKey(filename, generation));
+            if (!snapshot && manifestVersion != ObjectStore::kMissing) {
+                continue;
+            }
+            if (snapshot) {
+                FileStorageFromFile::parseLines(snapshot->data, inventory);
+            }
+            unordered_map<string_view, size_t> slots;
+            for (size_t i = 0; i < inventory.size(); i++) {
+                slots.emplace(inventory[i].getTitle(), i);
+            }
+            for (const auto& key : store->list(deltaPrefix(filename))) {
+                if (deltaNumber(filename, key) < firstDelta) {
+                    continue;  // Already part of the snapshot
+                }
+                auto delta = store->get(key);
+                if (delta) {
+                    applyDelta(delta->data, slots, inventory);
+                    deltaBytes += delta->data.size();
+                }
+            }
+            return inventory;
+        }
+        cerr << "[Cloud] Error downloading snapshot!" << endl;
+        stale = true;  // Saving what we have would overwrite the stored inventory
+        return {};
     }
-};
 
+private:
+    // Pick up the manifest and the delta numbering of filename when we start using it
+    void bind(const string& filename) {
+        if (boundFile == filename) {
+            return;
+        }
+        boundFile = filename;
+        stale = false;
+        firstDelta = 0;
+        generation = 0;
+        manifestVersion = ObjectStore::kMissing;
+        snapshotBytes = 0;
+        deltaBytes = 0;
+        // Manifest: "<first delta> <snapshot bytes> <generation>" (no generation: the unnumbered snapshot)
+        if (auto manifest = store->get(manifestKey(filename))) {
+            const char* end = manifest->data.data() + manifest->data.size();
+            auto [ptr, ec] = from_chars(manifest->data.data(), end, firstDelta);
+            if (ptr != end) {
+                ptr = from_chars(ptr + 1, end, snapshotBytes).ptr;
+            }
+            if (ptr != end && *ptr == ' ') {
+                from_chars(ptr + 1, end, generation);
+            }
+            manifestVersion = manifest->version;
+        }
+        nextDelta = firstDelta;
+        for (const auto& key : store->list(deltaPrefix(filename))) {
+            nextDelta = max(nextDelta, deltaNumber(filename, key) + 1);
+        }
+    }
+
+    // True (and stop saving) if another writer has claimed a delta number we have not reached yet
+    bool hasForeignDeltas(const string& filename) {
+        vector<string> keys = store->list(deltaPrefix(filename));
+        if (!keys.empty() && deltaNumber(filename, keys.back()) >= nextDelta) {
+            cerr << "[Cloud] Another writer saved changes; reload before saving" << endl;
+            stale = true;
+        }
+        return stale;
+    }
+
+    // Apply "title,quantity" records; unknown titles and malformed lines are skipped
+    static void applyDelta(string_view data, const unordered_map<string_view, size_t>& slots, vector<Book>& inventory) {
+        while (!data.empty()) {
+            size_t end = data.find('\n');
+            string_view line = data.substr(0, end);
+            data.remove_prefix(end == string_view::npos ? data.size() : end + 1);
+            size_t comma = line.rfind(',');
+            if (comma == string_view::npos) {
+                continue;
+            }
+            int quantity = 0;
+            auto [ptr, ec] = from_chars(line.data() + comma + 1, line.data() + line.size(), quantity);
+            auto it = slots.find(line.substr(0, comma));
+            if (ec == errc() && it != slots.end()) {
+                inventory[it->second].setQuantity(quantity);
+            }
+        }
+    }
+
+    // Generation 0 is the unnumbered snapshot written before snapshots had generations
+    static string snapshotKey(const string& filename, uint64_t generation) {
+        if (generation == 0) {
+            return filename + "/snapshot";
+        }
+        string digits = to_string(generation);
+        return filename + "/snapshot." + string(20 - digits.size(), '0') + digits;
+    }
+    static string manifestKey(const string& filename) { return filename + "/manifest"; }
+    static string deltaPrefix(const string& filename) { return filename + "/delta/"; }
+
+    // Zero-padded so that listing order is numeric order
+    static string deltaKey(const string& filename, uint64_t number) {
+        string digits = to_string(number);
+        return deltaPrefix(filename) + string(20 - digits.size(), '0') + digits;
+    }
+
+    static uint64_t deltaNumber(const string& filename, const string& key) {
+        uint64_t number = 0;
+        size_t start = deltaPrefix(filename).size();
+        from_chars(key.data() + start, key.data() + key.size(), number);
+        return number;
+    }
+
+    static constexpr size_t kMinCompactBytes = 1 << 16;  // Small catalogs still collect this much delta first
+
+    shared_ptr<ObjectStore> store;
+    string boundFile;  // File whose manifest state is cached below
+    uint64_t manifestVersion = ObjectStore::kMissing;  // Manifest version we last read or wrote
+    uint64_t generation = 0;  // Generation of the snapshot the manifest names
+    bool stale = false;  // Another writer changed the store since we loaded it; saves are refused
+    uint64_t firstDelta = 0;  // First delta not folded into the snapshot
+    uint64_t nextDelta = 0;  // Number the next delta will try to claim
+    size_t snapshotBytes = 0;  // Size of the current snapshot
+    size_t deltaBytes = 0;  // Size of the deltas written since it
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+#ifndef HOTSTOCK_H
+#define HOTSTOCK_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// HotStockCounter Class: Stock counter for a title that many threads sell at once
+// A single atomic quantity makes every sale bounce one cache line between all cores. Here the stock
+// is split across shards on separate cache lines and each thread sells from its own shard. A thread
+// whose shard is empty steals half of another shard's copies, so stock drifts to where the buyers are.
+// - Never oversells: a take only succeeds by lowering a shard that holds enough copies, and shards
+//   never go below zero.
+// - Goes negative like a Book: removing more copies than are in stock empties the shards and keeps
+//   the rest as a shortfall, which later restocks pay off before any copy can be sold.
+// - Out of stock is fast: after a full scan finds no copies the counter remembers it, and later
+//   sales fail after a few loads without writing anything, until stock is added again.
+// A sale of several copies may gather them from several shards; if there are not enough it puts
+// them back, and sales running meanwhile may briefly see fewer copies than there are.
+class HotStockCounter {
+public:
+    // shards = 0 uses one shard per hardware thread
+    explicit HotStockCounter(int quantity, size_t shards = 0)
+        : shardCount(max<size_t>(1, shards ? shards : thread::hardware_concurrency())),
+          shards(make_unique<Shard[]>(shardCount)) {
+        this->shards[0].stock.store(max(quantity, 0), memory_order_relaxed);
+        shortfall.store(max(-quantity, 0), memory_order_relaxed);
+    }
+
+    // Take count copies if that many are in stock
+    bool tryTake(int count) {
+        size_t home = homeShard();
+        if (takeFrom(shards[home], count)) {
+            return true;
+        }
+        uint64_t seen = restocks.load(memory_order_acquire);
+        if (emptyAt.load(memory_order_relaxed) == seen) {
+            return false;  // Known to be out of stock since the last restock
+        }
+        // Steal from the other shards: take half of a shard's copies (at least count) and keep the
+        // surplus in our own shard for the next sales from this thread
+        for (size_t i = 1; i < shardCount; i++) {
+            atomic<int>& victim = shards[(home + i) % shardCount].stock;
+            int available = victim.load(memory_order_relaxed);
+            while (available >= count) {
+                int grab = max(count, available / 2);
+                if (victim.compare_exchange_weak(available, available - grab, memory_order_relaxed)) {
+                    if (grab > count) {
+                        putBack(grab - count);  // Bumps restocks, so a scan that ran in between is not trusted
+                    }
+                    return true;
+                }
+            }
+        }
+        // No single shard holds count copies; gather them from all shards or put back what was found
+        int gathered = 0;
+        for (size_t i = 0; i < shardCount && gathered < count; i++) {
+            atomic<int>& shard = shards[(home + i) % shardCount].stock;
+            int available = shard.load(memory_order_relaxed);
+            while (available > 0) {
+                int grab = min(available, count - gathered);
+                if (shard.compare_exchange_weak(available, available - grab, memory_order_relaxed)) {
+                    gathered += grab;
+                    break;
+                }
+            }
+        }
+        if (gathered == count) {
+            return true;
+        }
+        if (gathered > 0) {
+            putBack(gathered);
+        } else {
+            emptyAt.store(seen, memory_order_relaxed);
+        }
+        return false;
+    }
+
+    // Add delta copies (a restock or a released reservation). A negative delta removes copies; what
+    // the shards cannot cover is owed, and the total goes negative as a Book's quantity would.
+    void add(int delta) {
+        if (delta < 0) {
+            shortfall.fetch_add(-delta, memory_order_relaxed);
+            payShortfall();
+            return;
+        }
+        // Pay off what is owed before any copy reaches a shard where it could be sold
+        int owed = shortfall.load(memory_order_relaxed);
+        while (owed > 0 && delta > 0 && !shortfall.compare_exchange_weak(owed, owed - min(owed, delta), memory_order_relaxed)) {
+        }
+        delta -= max(0, min(owed, delta));
+        if (delta > 0) {
+            putBack(delta);
+        }
+    }
+
+    // Copies in stock (negative while more were removed than there were). Exact when no sale or
+    // restock is running; otherwise a recent approximation.
+    int total() const {
+        int sum = 0;
+        for (size_t i = 0; i < shardCount; i++) {
+            sum += shards[i].stock.load(memory_order_relaxed);
+        }
+        return sum - shortfall.load(memory_order_relaxed);
+    }
+
+    size_t shardsUsed() const { return shardCount; }
+
+private:
+    // One shard per cache line, so sales on different shards never share a line
+    struct alignas(64) Shard {
+        atomic<int> stock{0};
+    };
+
+    // Take count copies from one shard if it holds that many
+    static bool takeFrom(Shard& shard, int count) {
+        int available = shard.stock.load(memory_order_relaxed);
+        while (available >= count) {
+            if (shard.stock.compare_exchange_weak(available, available - count, memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Return copies to this thread's shard and wake up sales that saw the counter empty
+    void putBack(int count) {
+        shards[homeShard()].stock.fetch_add(count, memory_order_relaxed);
+        restocks.fetch_add(1, memory_order_release);
+    }
+
+    // Take copies out of the shards to cover the shortfall, as far as they reach. The debt is claimed
+    // before its copies are taken and handed back if a sale got to them first.
+    void payShortfall() {
+        while (true) {
+            int owed = shortfall.load(memory_order_relaxed);
+            int available = 0;
+            for (size_t i = 0; i < shardCount; i++) {
+                available += shards[i].stock.load(memory_order_relaxed);
+            }
+            int pay = min(owed, available);
+            if (pay <= 0) {
+                return;
+            }
+            if (!shortfall.compare_exchange_weak(owed, owed - pay, memory_order_relaxed)) {
+                continue;
+            }
+            if (!tryTake(pay)) {
+                shortfall.fetch_add(pay, memory_order_relaxed);  // Sales got there first
+                return;
+            }
+        }
+    }
+
+    // Threads are numbered as they first sell and spread round-robin over the shards
+    size_t homeShard() const {
+        static atomic<size_t> nextThread{0};
+        thread_local size_t threadNumber = nextThread.fetch_add(1, memory_order_relaxed);
+        return threadNumber % shardCount;
+    }
+
+    size_t shardCount;
+    unique_ptr<Shard[]> shards;
+    // Restocks (and copies moved between shards) so far, and the count at which a full scan last found
+    // no copies; while the two are equal the counter is out of stock
+    alignas(64) atomic<uint64_t> restocks{1};
+    atomic<uint64_t> emptyAt{0};
+    atomic<int> shortfall{0};  // Copies removed beyond what the shards held, still to be paid off
+};
+
+#endif // HOTSTOCK_H
@@ -0,0 +1,115 @@
+#ifndef INVENTORYCOLUMNS_H
+#define INVENTORYCOLUMNS_H
+
+#include <vector>
+#include <span>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include "book.h"
+using namespace std;
+
+// InventoryColumns Class: Structure-of-arrays shadow of the numeric Book fields
+// Prices (cents) and quantities sit in two dense arrays indexed by inventory slot, so whole-catalog
+// scans touch 12 bytes per book instead of dragging titles and authors through the cache.
+// The owner appends a row for every book it adds and mirrors every quantity change here.
+class InventoryColumns {
+public:
+    void reserve(size_t n) {
+        priceCents.reserve(n);
+        quantities.reserve(n);
+    }
+
+    void append(const Book& book) {
+        priceCents.push_back(book.getPriceCents());
+        quantities.push_back(book.getQuantity());
+    }
+
+    // Mirror a quantity change made to the Book at slot (safe alongside other threads' changes)
+    void addQuantity(size_t slot, int delta) {
+        atomic_ref<int32_t>(quantities[slot]).fetch_add(delta, memory_order_relaxed);
+    }
+
+    // Overwrite the quantity at slot (for stock kept elsewhere and copied in)
+    void setQuantity(size_t slot, int quantity) {
+        atomic_ref<int32_t>(quantities[slot]).store(quantity, memory_order_relaxed);
+    }
+
+    // Copy the quantities into out (sized to the row count) while other threads may be changing them
+    void copyStock(span<int32_t> out) const {
+        for (size_t slot = 0; slot < out.size(); slot++) {
+            out[slot] = atomic_ref<int32_t>(const_cast<int32_t&>(quantities[slot])).load(memory_order_relaxed);
+        }
+    }
+
+    span<const int64_t> prices() const { return priceCents; }
+    span<const int32_t> stock() const { return quantities; }
+
+private:
+    vector<int64_t> priceCents;  // Price of the book at each slot, in cents
+    vector<int32_t> quantities;  // Quantity of the book at each slot
+};
+
+// Scan kernels over the columns. Each is a plain counted loop over contiguous arrays whose
+// conditions are folded into arithmetic, so the compiler can vectorize it.
+
+// Sum of price * quantity, in cents
+inline int64_t stockValueCents(span<const int64_t> prices, span<const int32_t> quantities) {
+    int64_t total = 0;
+    size_t n = min(prices.size(), quantities.size());
+    for (size_t i = 0; i < n; i++) {
+        total += prices[i] * quantities[i];
+    }
+    return total;
+}
+
+// Number of quantities below threshold
+inline size_t countBelow(span<const int32_t> quantities, int32_t threshold) {
+    size_t count = 0;
+    for (int32_t quantity : quantities) {
+        count += quantity < threshold;
+    }
+    return count;
+}
+
+// Slots whose quantity is below threshold, in slot order
+inline vector<size_t> slotsBelow(span<const int32_t> quantities, int32_t threshold) {
+    // Size the result with a cheap counting pass, then compact without branches: always write the
+    // slot, only advance past it on a match (the spare element absorbs the final unmatched write)
+    vector<size_t> slots(countBelow(quantities, threshold) + 1);
+    size_t found = 0;
+    for (size_t i = 0; i < quantities.size() && found + 1 < slots.size(); i++) {
+        slots[found] = i;
+        found += quantities[i] < threshold;
+    }
+    slots.resize(found);
+    return slots;
+}
+
+// Counts per price band for ascending edges e0 < e1 < ... < ek (cents):
+// result[0] counts prices below e0, result[i] counts [e(i-1), e(i)), result[k+1] counts e(k) and above.
+// Prices are walked in cache-sized blocks; each edge is a vectorizable count over the block, and
+// the bands are the differences between neighbouring edge counts.
+inline vector<size_t> priceBands(span<const int64_t> prices, span<const int64_t> edges) {
+    constexpr size_t kBlock = 2048;  // 16 KB of prices, stays in L1 across the edge passes
+    vector<size_t> atLeast(edges.size());
+    for (size_t start = 0; start < prices.size(); start += kBlock) {
+        span<const int64_t> block = prices.subspan(start, min(kBlock, prices.size() - start));
+        for (size_t e = 0; e < edges.size(); e++) {
+            size_t count = 0;
+            for (int64_t price : block) {
+                count += price >= edges[e];
+            }
+            atLeast[e] += count;
+        }
+    }
+    vector<size_t> bands(edges.size() + 1);
+    for (size_t b = 0; b <= edges.size(); b++) {
+        size_t from = b == 0 ? prices.size() : atLeast[b - 1];
+        size_t to = b == edges.size() ? 0 : atLeast[b];
+        bands[b] = from - to;
+    }
+    return bands;
+}
+
+#endif // INVENTORYCOLUMNS_H
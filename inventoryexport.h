@@ -0,0 +1,151 @@
+#ifndef INVENTORYEXPORT_H
+#define INVENTORYEXPORT_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <charconv>
+#include <cstdint>
+#include "book.h"
+using namespace std;
+
+// Output formats for inventory exports
+enum class ExportFormat {
+    Display,    // "Title: ..., Author: ..., Price: ..., Quantity: ..." (what displayInventory prints)
+    Csv,        // "ID,Title,Author,Price,Quantity", same layout as inventory.txt
+    JsonLines,  // One JSON object per book
+};
+
+// ExportOptions: What to export and how; offset and limit count books that pass the filter
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Display;
+    size_t offset = 0;  // Matching books to skip (page * page size)
+    size_t limit = SIZE_MAX;  // Most books to write
+    // Optional; books it rejects are not exported. Gets the book and its quantity at export time,
+    // which is what to test rather than book.getQuantity()
+    function<bool(const Book&, int quantity)> filter;
+};
+
+// InventoryExporter Class: Formats books into one large buffer and hands it to the sink in big writes
+// Nothing is flushed per line; the sink sees a write whenever the buffer fills and once at the end.
+class InventoryExporter {
+public:
+    InventoryExporter(ostream& out, ExportFormat format, size_t bufferSize = 1 << 16)
+        : out(out), format(format), bufferSize(bufferSize) {
+        buffer.reserve(bufferSize + 512);
+    }
+
+    // Write whatever is still buffered
+    ~InventoryExporter() { drain(); }
+
+    InventoryExporter(const InventoryExporter&) = delete;
+    InventoryExporter& operator=(const InventoryExporter&) = delete;
+
+    // Append one book; id is its inventory slot
+    void write(size_t id, const Book& book) {
+        write(id, book, book.getQuantity());
+    }
+
+    // Append one book with the given quantity in place of its own (used for snapshot exports)
+    void write(size_t id, const Book& book, int quantity) {
+        switch (format) {
+        case ExportFormat::Display:
+            buffer += "Title: ";
+            buffer += book.getTitle();
+            buffer += ", Author: ";
+            buffer += book.getAuthor();
+            buffer += ", Price: ";
+            appendPrice(book.getPriceCents());
+            buffer += ", Quantity: ";
+            appendNumber(quantity);
+            break;
+        case ExportFormat::Csv:
+            appendNumber(id);
+            buffer += ',';
+            buffer += book.getTitle();
+            buffer += ',';
+            buffer += book.getAuthor();
+            buffer += ',';
+            appendPrice(book.getPriceCents());
+            buffer += ',';
+            appendNumber(quantity);
+            break;
+        case ExportFormat::JsonLines:
+            buffer += "{\"id\":";
+            appendNumber(id);
+            buffer += ",\"title\":";
+            appendJsonString(book.getTitle());
+            buffer += ",\"author\":";
+            appendJsonString(book.getAuthor());
+            buffer += ",\"price\":";
+            appendPrice(book.getPriceCents());
+            buffer += ",\"quantity\":";
+            appendNumber(quantity);
+            buffer += '}';
+            break;
+        }
+        buffer += '\n';
+        if (buffer.size() >= bufferSize) {
+            drain();
+        }
+    }
+
+    // Hand buffered output to the sink
+    void drain() {
+        if (!buffer.empty()) {
+            out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+private:
+    template <typename T>
+    void appendNumber(T value) {
+        char digits[24];
+        auto [end, ec] = to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, end);
+    }
+
+    // Cents as a plain decimal without trailing zeros: 37000 -> "370", 52550 -> "525.5"
+    void appendPrice(long long cents) {
+        if (cents < 0) {
+            buffer += '-';
+            cents = -cents;
+        }
+        appendNumber(cents / 100);
+        int fraction = static_cast<int>(cents % 100);
+        if (fraction != 0) {
+            buffer += '.';
+            buffer += static_cast<char>('0' + fraction / 10);
+            if (fraction % 10 != 0) {
+                buffer += static_cast<char>('0' + fraction % 10);
+            }
+        }
+    }
+
+    void appendJsonString(string_view text) {
+        buffer += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                buffer += '\\';
+                buffer += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                buffer += "\\u00";
+                buffer += hex[(c >> 4) & 0xf];
+                buffer += hex[c & 0xf];
+            } else {
+                buffer += c;
+            }
+        }
+        buffer += '"';
+    }
+
+    ostream& out;  // Sink
+    ExportFormat format;
+    size_t bufferSize;  // Buffered bytes that trigger a write
+    string buffer;
+};
+
+#endif // INVENTORYEXPORT_H
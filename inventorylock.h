@@ -0,0 +1,67 @@
+#ifndef INVENTORYLOCK_H
+#define INVENTORYLOCK_H
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+using namespace std;
+
+// InventoryLock Class: Advisory lock that every program writing an inventory file holds while it runs
+// Taken with flock on "<inventory file>.lock" rather than on the file itself, because snapshots are
+// renamed into place and a lock on the old file would no longer cover the new one.
+// - Programs that write the file on their own (the server, the importer, a plain terminal, the
+//   converter) take it exclusively, so none of them journals or compacts stale stock over another.
+// - The --shared terminals write it together through one segment, so they share it; the last one
+//   to leave can tell by upgrading to exclusive (tryUpgrade).
+// The lock is released when the object is destroyed or the process exits, even on a crash.
+class InventoryLock {
+public:
+    enum class Mode { Exclusive, Shared };
+
+    // Try to take the lock without waiting; check held() before writing the file
+    InventoryLock(const string& inventoryFile, Mode mode) : filename(inventoryFile + ".lock") {
+        fd = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            cerr << "Cannot open lock file " << filename << ": " << strerror(errno) << endl;
+            return;
+        }
+        if (flock(fd, (mode == Mode::Exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB) != 0) {
+            if (errno == EWOULDBLOCK) {
+                cerr << inventoryFile << " is in use by another program (" << filename << " is locked)" << endl;
+            } else {
+                cerr << "Cannot lock " << filename << ": " << strerror(errno) << endl;
+            }
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    ~InventoryLock() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    InventoryLock(const InventoryLock&) = delete;
+    InventoryLock& operator=(const InventoryLock&) = delete;
+
+    // Whether this process holds the lock
+    bool held() const { return fd >= 0; }
+
+    // Turn a shared lock into an exclusive one without waiting. Fails while anyone else holds it.
+    // flock drops the shared lock before trying, so a failed upgrade may leave nothing held:
+    // only call this once done writing the file.
+    bool tryUpgrade() {
+        return fd >= 0 && flock(fd, LOCK_EX | LOCK_NB) == 0;
+    }
+
+private:
+    string filename;
+    int fd = -1;
+};
+
+#endif
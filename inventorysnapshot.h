@@ -0,0 +1,105 @@
+#ifndef INVENTORYSNAPSHOT_H
+#define INVENTORYSNAPSHOT_H
+
+#include <vector>
+#include <memory>
+#include <span>
+#include <algorithm>
+#include <cstdint>
+#include "book.h"
+using namespace std;
+
+// A run of consecutive inventory slots copied into the snapshot catalog. Segments are immutable once
+// built, so every snapshot that covers them shares them instead of copying the books again.
+struct CatalogSegment {
+    size_t firstSlot;
+    vector<Book> books;  // Titles, authors and prices; the quantities in here are stale
+};
+
+// InventorySnapshot Class: Immutable, consistent view of the inventory at one point in time
+// The catalog part (titles, authors, prices) is shared with other snapshots; the quantities are this
+// snapshot's own copy, taken while no stock change was half-applied. A snapshot stays valid and
+// unchanged for as long as it is held, whatever the library does meanwhile, and is freed with its
+// last reference.
+class InventorySnapshot {
+public:
+    InventorySnapshot(vector<shared_ptr<const CatalogSegment>> segments, vector<int32_t> quantities)
+        : segments(std::move(segments)), quantityColumn(std::move(quantities)) {}
+
+    // Number of books in the snapshot
+    size_t size() const { return quantityColumn.size(); }
+
+    // Title, author and price of the book at slot (use quantity(slot) for its stock)
+    const Book& book(size_t slot) const {
+        auto it = upper_bound(segments.begin(), segments.end(), slot,
+                              [](size_t s, const shared_ptr<const CatalogSegment>& segment) { return s < segment->firstSlot; });
+        const CatalogSegment& segment = **(it - 1);
+        return segment.books[slot - segment.firstSlot];
+    }
+
+    // Quantity of the book at slot when the snapshot was taken
+    int quantity(size_t slot) const { return quantityColumn[slot]; }
+
+    // All quantities in slot order, for the scan kernels in inventorycolumns.h
+    span<const int32_t> quantities() const { return quantityColumn; }
+
+    // Call f(slot, book, quantity) for every book in slot order; f returns false to stop early
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& segment : segments) {
+            for (size_t i = 0; i < segment->books.size(); i++) {
+                size_t slot = segment->firstSlot + i;
+                if (!f(slot, segment->books[i], quantityColumn[slot])) {
+                    return;
+                }
+            }
+        }
+    }
+
+private:
+    vector<shared_ptr<const CatalogSegment>> segments;  // Cover slots [0, size()) in order
+    vector<int32_t> quantityColumn;  // Quantity of each slot at snapshot time
+};
+
+// SnapshotCatalog Class: The growing, shared catalog that snapshots are cut from
+// extend copies only books it has not seen yet into a new segment, then merges segments so their
+// sizes shrink geometrically from oldest to newest (as SortedRunIndex does with its runs). A catalog of
+// n books therefore has O(log n) segments and each book is copied O(log n) times over its lifetime.
+// Merging builds a new segment; the old ones live on in any snapshot still using them.
+class SnapshotCatalog {
+public:
+    // Books copied so far
+    size_t size() const { return covered; }
+
+    // Copy inventory[size(), inventory.size()) into the catalog
+    void extend(span<const Book> inventory) {
+        if (inventory.size() <= covered) {
+            return;
+        }
+        auto segment = make_shared<CatalogSegment>();
+        segment->firstSlot = covered;
+        segment->books.assign(inventory.begin() + covered, inventory.end());
+        covered = inventory.size();
+        while (!segments.empty() && segments.back()->books.size() <= 2 * segment->books.size()) {
+            auto merged = make_shared<CatalogSegment>();
+            merged->firstSlot = segments.back()->firstSlot;
+            merged->books.reserve(segments.back()->books.size() + segment->books.size());
+            merged->books.assign(segments.back()->books.begin(), segments.back()->books.end());
+            merged->books.insert(merged->books.end(), segment->books.begin(), segment->books.end());
+            segments.pop_back();
+            segment = std::move(merged);
+        }
+        segments.push_back(std::move(segment));
+    }
+
+    // Cut a snapshot from the current catalog; quantities holds the stock of every book in it
+    shared_ptr<const InventorySnapshot> snapshot(vector<int32_t> quantities) const {
+        return make_shared<const InventorySnapshot>(segments, std::move(quantities));
+    }
+
+private:
+    vector<shared_ptr<const CatalogSegment>> segments;  // Oldest (largest) first
+    size_t covered = 0;  // Slots copied into segments
+};
+
+#endif // INVENTORYSNAPSHOT_H
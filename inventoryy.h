@@ -3,7 +3,7 @@
 
 #include <string>
 #include <vector>
-#include "Book.h"
+#include "book.h"
 
 // Inventory Management Interface: Adheres to the Interface Segregation Principle (ISP)
 // Provides a specific interface for managing inventory-related operations.
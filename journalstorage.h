@@ -0,0 +1,117 @@
+#ifndef JOURNALSTORAGE_H
+#define JOURNALSTORAGE_H
+
+#include <cstdio>
+#include <charconv>
+#include <unordered_map>
+#include "filestorage.h"
+
+// JournaledFileStorage Class: Snapshot plus append-only journal of stock changes
+// saveToFile writes a full CSV snapshot; saveChanges only appends one "title,quantity" record per
+// changed book to <filename>.journal, so a sale costs the same no matter how big the catalog is.
+// Every compactEvery records the journal is folded into a fresh snapshot and emptied, which keeps
+// the amount of journal replayed at startup bounded.
+class JournaledFileStorage : public FileStorageBase {
+public:
+    // loadThreads > 1 parses the snapshot on that many threads (see FileStorageFromFile)
+    explicit JournaledFileStorage(size_t compactEvery = 4096, size_t loadThreads = 1)
+        : snapshot(loadThreads), compactEvery(compactEvery) {}
+
+    // Write a fresh snapshot and start an empty journal (this is also the compaction step)
+    void saveToFile(const vector<Book>& inventory, const string& filename) override {
+        // Write next to the old snapshot and rename, so a crash never leaves a half-written snapshot
+        string tempName = filename + ".tmp";
+        snapshot.saveToFile(inventory, tempName);
+        if (rename(tempName.c_str(), filename.c_str()) != 0) {
+            cerr << "Error replacing snapshot file!" << endl;
+            return;
+        }
+        // Journal records hold absolute quantities, so replaying them over the new snapshot is harmless
+        // if we stop between the rename and the truncation.
+        journal.close();
+        journal.open(journalName(filename), ios::trunc);
+        journalFile = filename;
+        pendingRecords = 0;
+    }
+
+    // Append one record per changed slot instead of rewriting the inventory
+    void saveChanges(const vector<Book>& inventory, span<const size_t> changed, const string& filename) override {
+        if (!journal.is_open() || journalFile != filename) {
+            journal.close();
+            journal.open(journalName(filename), ios::app);
+            journalFile = filename;
+        }
+        if (!journal.is_open()) {
+            cerr << "Error opening journal file!" << endl;
+            return;
+        }
+        streampos before = 0;
+        if constexpr (kMetricsEnabled) {
+            before = journal.tellp();  // tellp asks the filebuf to seek, so only when counting bytes
+        }
+        for (size_t slot : changed) {
+            const Book& book = inventory[slot];
+            journal << book.getTitle() << "," << book.getQuantity() << "\n";
+        }
+        journal.flush();
+        if constexpr (kMetricsEnabled) {
+            Metrics::count(Counter::BytesWritten, static_cast<uint64_t>(journal.tellp() - before));
+        }
+        pendingRecords += changed.size();
+        if (pendingRecords >= compactEvery) {
+            saveToFile(inventory, filename);
+        }
+    }
+
+    // Load the last snapshot and replay the journal written since it
+    vector<Book> loadFromFile(const string& filename) override {
+        vector<Book> inventory = snapshot.loadFromFile(filename);
+        pendingRecords = replayJournal(journalName(filename), inventory);
+        return inventory;
+    }
+
+private:
+    static string journalName(const string& filename) { return filename + ".journal"; }
+
+    // Apply journal records to a freshly loaded snapshot; returns the number of records applied
+    static size_t replayJournal(const string& name, vector<Book>& inventory) {
+        ifstream file(name);
+        if (!file.is_open()) {
+            return 0;  // No journal yet: the snapshot is already current
+        }
+        unordered_map<string, size_t> slots;
+        for (size_t i = 0; i < inventory.size(); i++) {
+            slots.emplace(inventory[i].getTitle(), i);
+        }
+        size_t applied = 0;
+        string line;
+        while (getline(file, line)) {
+            if (file.eof()) {
+                break;  // Last record has no newline: it was torn by a crash, skip it
+            }
+            Metrics::count(Counter::BytesRead, line.size() + 1);
+            size_t comma = line.rfind(',');
+            if (comma == string::npos) {
+                continue;
+            }
+            int quantity = 0;
+            const char* end = line.data() + line.size();
+            auto [ptr, ec] = from_chars(line.data() + comma + 1, end, quantity);
+            auto it = slots.find(line.substr(0, comma));
+            if (ec != errc() || ptr != end || it == slots.end()) {
+                continue;
+            }
+            inventory[it->second].setQuantity(quantity);
+            applied++;
+        }
+        return applied;
+    }
+
+    FileStorageFromFile snapshot;  // Snapshot format is the regular inventory CSV
+    ofstream journal;  // Journal kept open between sales
+    string journalFile;  // Snapshot file the open journal belongs to
+    size_t compactEvery;  // Journal records allowed before compaction
+    size_t pendingRecords = 0;  // Journal records since the last snapshot
+};
+
+#endif // JOURNALSTORAGE_H
@@ -2,69 +2,911 @@
 #define LIBRARY_H
 
 #include <vector>
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include "inventoryy.h"
-#include "Book.h"
+#include "book.h"
 #include "filestorage.h"
+#include "asyncpersistence.h"
+#include "searchindex.h"
+#include "sortedrunindex.h"
+#include "inventoryexport.h"
+#include "inventorycolumns.h"
+#include "inventorysnapshot.h"
+#include "hotstock.h"
+#include "salestracker.h"
+#include "saleshistory.h"
+#include "metrics.h"
+
+// TitleHash: Transparent hash for the title index
+// Lets the index be probed with a string_view, so a lookup never allocates a temporary string.
+struct TitleHash {
+    using is_transparent = void;
+    size_t operator()(string_view title) const { return hash<string_view>{}(title); }
+};
+
+// StockOperation: One line of a batch; a negative delta sells copies, a positive delta restocks
+struct StockOperation {
+    string title;
+    int delta;
+};
+
+// MergeResult: Outcome of Library::mergeBooks
+struct MergeResult {
+    size_t restocked = 0;  // Delivery rows added to the stock of a title already present (or earlier in the delivery)
+    size_t added = 0;      // New titles appended to the inventory
+};
+
+// BatchResult: Outcome of Library::applyBatch
+struct BatchResult {
+    bool applied = false;  // Every operation was applied (otherwise none were)
+    double saleTotal = 0;  // Price of all copies sold by the batch
+};
+
+// BatchReservation: Copies held by Library::reserveBatch for a cart that is still being paid for
+struct BatchReservation {
+    bool reserved = false;  // Every copy is held (otherwise none are)
+    double saleTotal = 0;  // Price of all held copies
+    vector<pair<size_t, int>> held;  // (slot, copies held), one entry per title
+};
 
 // Library Class: Adheres to the Liskov Substitution Principle (LSP)
 // Can be used interchangeably with the InventoryManager interface.
+//
+// Thread safety: any number of threads may sell, restock and look up books at once.
+// - inventoryMutex guards the shape of the inventory (the vector and the title, search and price indexes).
+//   Sales and restocks only take it shared; addBook and loadInventory take it exclusively.
+// - Quantities are per-record atomics (Book::tryTake/addQuantity), so sales of different titles
+//   never wait on each other and the check-and-decrement in a sale can never oversell.
+// - storageMutex serializes calls into the storage backend. It is always taken before inventoryMutex.
+// - Long reads (reports, exports) work on a snapshot() and hold no lock while they run; taking the
+//   snapshot holds the shared lock, so sales and batches carry on while it is taken.
+// - Titles marked with setHotTitle keep their stock in a sharded HotStockCounter instead of the Book.
+//   The Book and the quantity column are brought up to date before anything reads them.
+// - With enableSalesTracking, sales are counted per title without a shared lock and ranked when the
+//   bestsellers are read; the SalesTracker itself is guarded by trackerMutex (taken after
+//   inventoryMutex), which a stock change only takes when the book crosses the reorder threshold.
+// - With enableSalesHistory, every sale is also appended to a SalesHistory, which has its own lock.
+// Slots never move or disappear, so a slot from findBook stays valid while books are added.
 class Library : public InventoryManager {
 public:
     // Constructor to initialize the library with a storage mechanism
-    Library(unique_ptr<FileStorageBase> storage) : storage(std::move(storage)) {}
+    // Changes are saved to storageFile (inventory.txt unless the caller picks another file).
+    Library(unique_ptr<FileStorageBase> storage, string storageFile = "inventory.txt")
+        : storage(std::move(storage)), storageFile(std::move(storageFile)) {}
 
     // Add a book to the library inventory
     void addBook(const Book& book) override {
-        inventory.push_back(book);
+        unique_lock lock(inventoryMutex);
+        addBookLocked(book);
+    }
+
+    // Add many books with one lock and one pass over each index (far cheaper than addBook per book)
+    void addBooks(vector<Book> books) {
+        unique_lock lock(inventoryMutex);
+        appendBooksLocked(std::move(books));
+    }
+
+    // Merge a delivery into the inventory by title in one hash pass: rows for known titles add their
+    // quantity to the existing book (its price and author stay), rows for new titles are appended, and
+    // repeated new titles within the delivery are folded into one book. The inventory is then
+    // written to storage once. Returns how many rows went each way.
+    MergeResult mergeBooks(vector<Book> delivery) {
+        MergeResult result;
+        lock_guard storageLock(storageMutex);
+        {
+            unique_lock lock(inventoryMutex);
+            vector<bool> isNew(delivery.size());
+            unordered_map<string_view, size_t, TitleHash, equal_to<>> firstNew;  // New title -> its first row
+            for (size_t i = 0; i < delivery.size(); i++) {
+                const Book& row = delivery[i];
+                if (auto slot = findBookLocked(row.getTitle())) {
+                    addStock(*slot, row.getQuantity());
+                    result.restocked++;
+                } else if (auto [it, inserted] = firstNew.emplace(row.getTitle(), i); !inserted) {
+                    delivery[it->second].addQuantity(row.getQuantity());
+                    result.restocked++;
+                } else {
+                    isNew[i] = true;
+                }
+            }
+            firstNew.clear();  // Its keys point into delivery, which is about to be moved from
+            vector<Book> fresh;
+            fresh.reserve(delivery.size() - result.restocked);
+            for (size_t i = 0; i < delivery.size(); i++) {
+                if (isNew[i]) {
+                    fresh.push_back(std::move(delivery[i]));
+                }
+            }
+            result.added = fresh.size();
+            appendBooksLocked(std::move(fresh));
+        }
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        ScopedLatency saveTimer(Operation::StorageSave);
+        storage->saveToFile(inventory, storageFile);
+        return result;
     }
 
     // Display the library inventory
     void displayInventory() const override {
-        for (const auto& book : inventory) {
-            cout << "Title: " << book.getTitle() << ", Author: " << book.getAuthor()
-                 << ", Price: " << book.getPrice() << ", Quantity: " << book.getQuantity() << endl;
+        exportInventory(cout, {});
+    }
+
+    // Stream books to out in the chosen format, optionally filtered and paged.
+    // Output is built in one large buffer with no per-line flush. Returns the number of books written.
+    // The export reads a snapshot, so it is consistent and never holds up sales however long it takes.
+    size_t exportInventory(ostream& out, const ExportOptions& options) const {
+        InventoryExporter exporter(out, options.format);
+        size_t skipped = 0, written = 0;
+        if (options.limit == 0) {
+            return 0;
+        }
+        snapshot()->forEach([&](size_t slot, const Book& book, int quantity) {
+            if (options.filter && !options.filter(book, quantity)) {
+                return true;
+            }
+            if (skipped < options.offset) {
+                skipped++;
+                return true;
+            }
+            exporter.write(slot, book, quantity);
+            return ++written < options.limit;
+        });
+        return written;
+    }
+
+    // Immutable view of the whole inventory, safe to read from any thread for as long as it is held.
+    // It is taken under the shared lock, so sales and batches carry on while the quantities are copied
+    // (4 bytes per book); only adding books waits. No batch is ever half-applied in a snapshot (see
+    // batchEpoch), and each book shows a quantity it had while the snapshot was taken. Titles, authors
+    // and prices come from a catalog shared by all snapshots, where only books added since the
+    // previous snapshot have to be copied.
+    shared_ptr<const InventorySnapshot> snapshot() const {
+        lock_guard snapshotLock(snapshotMutex);
+        shared_lock lock(inventoryMutex);
+        snapshotCatalog.extend(inventory);
+        // Open a new epoch and wait for the batches begun before it. Batches begun from now on record
+        // each book's quantity before they change it, and the copy is rolled back to those values.
+        uint64_t epoch = batchEpoch.load() + 1;
+        copyingEpoch.store(epoch);
+        batchEpoch.store(epoch);
+        while (batchesRunning[(epoch - 1) & 1].load() != 0) {
+            this_thread::yield();
+        }
+        drainedEpoch.store(epoch);
+        vector<int32_t> quantities(inventory.size());
+        columns.copyStock(quantities);
+        for (const auto& [slot, counter] : hotTitles) {
+            quantities[slot] = counter->total();
+        }
+        {
+            lock_guard preimageLock(preimageMutex);
+            // A book's first preimage is its quantity before any of the newer batches touched it
+            for (auto it = preimages.rbegin(); it != preimages.rend(); ++it) {
+                quantities[it->first] = it->second;
+            }
+            preimages.clear();
+            copyingEpoch.store(0);
         }
+        return snapshotCatalog.snapshot(std::move(quantities));
+    }
+
+    // Find the inventory slot of a book by title (no allocation per probe)
+    optional<size_t> findBook(string_view title) const {
+        shared_lock lock(inventoryMutex);
+        return findBookLocked(title);
+    }
+
+    // Get a copy of the book stored at an inventory slot returned by findBook
+    Book getBook(size_t slot) const {
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        return inventory[slot];
+    }
+
+    // Read the book at a slot in place, without copying it.
+    // f runs under the shared inventory lock, so it must not call back into the library.
+    template <typename F>
+    auto readBook(size_t slot, F&& f) const {
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        return f(inventory[slot]);
+    }
+
+    // Autocomplete: slots of books whose title starts with prefix (case-insensitive), in title order
+    vector<size_t> findByTitlePrefix(string_view prefix, size_t limit = 20) const {
+        shared_lock lock(inventoryMutex);
+        return search.titlesWithPrefix(prefix, limit);
+    }
+
+    // Slots of all books by an author (case-insensitive), in inventory order
+    vector<size_t> findByAuthor(string_view author) const {
+        shared_lock lock(inventoryMutex);
+        return search.booksByAuthor(author);
+    }
+
+    // Slots of books whose title or author contains every word of query, in inventory order
+    vector<size_t> searchKeywords(string_view query, size_t limit = 20) const {
+        shared_lock lock(inventoryMutex);
+        return search.keywordSearch(query, limit);
+    }
+
+    // Visit the books priced minPrice..maxPrice (inclusive) in price order, equal prices in slot order,
+    // as visit(slot, book) until it returns false. Books are read in place; visit runs under the shared
+    // inventory lock, so it must not call back into the library. Check book.getQuantity() to keep
+    // only titles in stock.
+    template <typename Visit>
+    void forEachInPriceRange(double minPrice, double maxPrice, Visit visit) const {
+        long long lowCents = llround(minPrice * 100), highCents = llround(maxPrice * 100);
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        priceOrder.scan(lowCents, [&](long long cents) { return cents <= highCents; },
+            [&](const SortedRunIndex<long long>::Entry& entry) { return visit(size_t(entry.second), as_const(inventory[entry.second])); });
+    }
+
+    // Visit the books whose author (case-insensitive) lies in fromAuthor..toAuthor as visit(slot, book)
+    // until it returns false: authors in name order, each author's books in inventory order. Names are
+    // compared on their first toAuthor.size() characters at the top end, so "a".."c" covers authors
+    // starting with a, b or c. Like forEachInPriceRange, visit runs under the shared lock.
+    template <typename Visit>
+    void forEachByAuthorRange(string_view fromAuthor, string_view toAuthor, Visit visit) const {
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        search.forEachAuthorInRange(fromAuthor, toAuthor, [&](uint32_t slot) { return visit(size_t(slot), as_const(inventory[slot])); });
     }
 
     // Update the stock of a book
     bool updateStock(const string& title, int quantity) override {
-        for (auto& book : inventory) {
-            if (book.getTitle() == title) {
-                book.setQuantity(book.getQuantity() + quantity);
-                return true;
-            }
+        ScopedLatency timer(Operation::UpdateStock);
+        auto slot = findBook(title);
+        if (!slot) {
+            return false;
         }
-        return false;
+        {
+            shared_lock lock(inventoryMutex);
+            addStock(*slot, quantity);
+        }
+        persistChange(*slot);
+        return true;
     }
 
     // Sell a book from the library
-    bool sellBook(const string& title) {
-        for (auto& book : inventory) {
-            if (book.getTitle() == title && book.getQuantity() > 0) {
-                book.setQuantity(book.getQuantity() - 1);
-                storage->saveToFile(inventory, "inventory.txt");  // Save changes to storage
-                return true;
+    bool sellBook(string_view title) {
+        auto slot = findBook(title);
+        return slot && sellBookAt(*slot);
+    }
+
+    // Sell the book at a slot already resolved through findBook
+    bool sellBookAt(size_t slot) {
+        ScopedLatency timer(Operation::SellBook);
+        if (!reserveStock(slot)) {
+            Metrics::count(Counter::OutOfStock);
+            return false;
+        }
+        commitReservation(slot);  // Save changes to storage
+        return true;
+    }
+
+    // Hold count copies of the book at slot for a checkout that is still being paid for.
+    // The copies leave the sellable stock at once, so nobody else can sell them; the checkout then
+    // ends with commitReservation (sold) or releaseReservation (put back). Returns false if short.
+    bool reserveStock(size_t slot, int count = 1) {
+        shared_lock lock(inventoryMutex);
+        return takeStock(slot, count);
+    }
+
+    // Finish a reservation of count copies as a sale and save the book's stock
+    void commitReservation(size_t slot, int count = 1) {
+        if (tracker || history) {
+            shared_lock lock(inventoryMutex);
+            trackSale(slot, count);
+        }
+        persistChange(slot);
+    }
+
+    // Return reserved copies to the stock. The book is saved too, because another change to it may
+    // have written the reduced quantity while the copies were held.
+    void releaseReservation(size_t slot, int count = 1) {
+        {
+            shared_lock lock(inventoryMutex);
+            addStock(slot, count);
+        }
+        persistChange(slot);
+    }
+
+    // Apply a list of stock operations all-or-nothing and persist them with a single storage call.
+    // All titles are resolved in one pass; if a title is missing or any sale lacks stock, nothing changes.
+    // Sales are final at once; a cart that may still be declined uses reserveBatch instead.
+    BatchResult applyBatch(const vector<StockOperation>& operations) {
+        ScopedLatency timer(Operation::ApplyBatch);
+        BatchResult result;
+        vector<pair<size_t, int>> changes;  // (slot, net delta), one entry per title
+        {
+            shared_lock lock(inventoryMutex);
+            if (!resolveLocked(operations, changes)) {
+                return result;
+            }
+            BatchScope batch(*this, changes);
+            if (!takeAllLocked(changes)) {
+                return result;
+            }
+            long long saleCents = 0;
+            for (auto [slot, delta] : changes) {
+                if (delta > 0) {
+                    addStock(slot, delta);
+                } else {
+                    saleCents += -delta * inventory[slot].getPriceCents();
+                    trackSale(slot, -delta);
+                }
+            }
+            result.saleTotal = saleCents / 100.0;
+        }
+        persistBatch(changes);
+        result.applied = true;
+        return result;
+    }
+
+    // Hold one copy of each title in a cart (repeat a title for more copies) while it is paid for,
+    // all or nothing, like reserveStock does for one book. The checkout then ends with commitBatch
+    // (sold) or releaseBatch (put back). reserved is false if a title is missing or short.
+    BatchReservation reserveBatch(const vector<string>& titles) {
+        ScopedLatency timer(Operation::ApplyBatch);
+        vector<StockOperation> operations;
+        operations.reserve(titles.size());
+        for (const auto& title : titles) {
+            operations.push_back({title, -1});
+        }
+        BatchReservation reservation;
+        shared_lock lock(inventoryMutex);
+        if (!resolveLocked(operations, reservation.held)) {
+            reservation.held.clear();
+            return reservation;
+        }
+        BatchScope batch(*this, reservation.held);
+        if (!takeAllLocked(reservation.held)) {
+            reservation.held.clear();
+            return reservation;
+        }
+        long long saleCents = 0;
+        for (auto& [slot, copies] : reservation.held) {
+            copies = -copies;
+            saleCents += copies * inventory[slot].getPriceCents();
+        }
+        reservation.saleTotal = saleCents / 100.0;
+        reservation.reserved = true;
+        return reservation;
+    }
+
+    // Finish a cart reservation as a sale and save its books with a single storage call
+    void commitBatch(const BatchReservation& reservation) {
+        if (tracker || history) {
+            shared_lock lock(inventoryMutex);
+            for (auto [slot, copies] : reservation.held) {
+                trackSale(slot, copies);
+            }
+        }
+        persistBatch(reservation.held);
+    }
+
+    // Return a cart's reserved copies to the stock and save its books (see releaseReservation)
+    void releaseBatch(const BatchReservation& reservation) {
+        {
+            shared_lock lock(inventoryMutex);
+            BatchScope batch(*this, reservation.held);
+            for (auto [slot, copies] : reservation.held) {
+                addStock(slot, copies);
+            }
+        }
+        persistBatch(reservation.held);
+    }
+
+    // Apply each operation on its own, for independent requests that arrive together: a missing
+    // title or a short sale fails just that operation. All changes are persisted with one storage call.
+    // applied[i] tells whether operations[i] took effect.
+    vector<bool> applyEach(const vector<StockOperation>& operations) {
+        ScopedLatency timer(Operation::ApplyBatch);
+        vector<bool> applied(operations.size());
+        vector<size_t> slots;
+        slots.reserve(operations.size());
+        {
+            shared_lock lock(inventoryMutex);
+            for (size_t i = 0; i < operations.size(); i++) {
+                auto slot = findBookLocked(operations[i].title);
+                if (!slot) {
+                    continue;
+                }
+                int delta = operations[i].delta;
+                if (delta < 0 && !takeStock(*slot, -delta)) {
+                    Metrics::count(Counter::OutOfStock);
+                    continue;
+                }
+                if (delta > 0) {
+                    addStock(*slot, delta);
+                } else {
+                    trackSale(*slot, -delta);
+                }
+                applied[i] = true;
+                slots.push_back(*slot);
+            }
+        }
+        if (!slots.empty()) {
+            sort(slots.begin(), slots.end());
+            slots.erase(unique(slots.begin(), slots.end()), slots.end());
+            persistChanges(slots);
+        }
+        return applied;
+    }
+
+    // Total value of all stock (sum of price * quantity), in cents
+    long long totalStockValueCents() const {
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        return stockValueCents(columns.prices(), columns.stock());
+    }
+
+    // Total value of all stock
+    double totalStockValue() const {
+        return totalStockValueCents() / 100.0;
+    }
+
+    // Slots of books with fewer than threshold copies in stock, in inventory order.
+    // Answered from the sales tracker's reorder list when the threshold is within it and the list is
+    // short next to the catalog (sorting a long one costs more than the column scan), otherwise by a scan.
+    vector<size_t> lowStock(int threshold) const {
+        shared_lock lock(inventoryMutex);
+        if (tracker && threshold > 0 && threshold <= tracker->reorderThreshold()) {
+            lock_guard trackerLock(trackerMutex);
+            if (tracker->lowCount() * 32 < inventory.size()) {
+                return tracker->belowThreshold(threshold);
             }
         }
-        return false;
+        settleHotLocked();
+        return slotsBelow(columns.stock(), threshold);
+    }
+
+    // Number of books in each price band. edges must be ascending; the result has edges.size() + 1
+    // counts: below edges[0], then [edges[i-1], edges[i]) for each pair, then edges.back() and above.
+    vector<size_t> priceBandCounts(const vector<double>& edges) const {
+        vector<int64_t> edgeCents;
+        edgeCents.reserve(edges.size());
+        for (double edge : edges) {
+            edgeCents.push_back(llround(edge * 100));
+        }
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        return priceBands(columns.prices(), edgeCents);
+    }
+
+    // Mark a title as hot ahead of a flash sale, or back to normal once it has passed.
+    // A hot title's stock moves into a HotStockCounter split over shards (one per hardware thread
+    // unless given), so thousands of concurrent buyers stop contending on the Book's single counter.
+    // Returns false if the title is unknown.
+    bool setHotTitle(string_view title, bool hot = true, size_t shards = 0) {
+        unique_lock lock(inventoryMutex);
+        auto slot = findBookLocked(title);
+        if (!slot) {
+            return false;
+        }
+        auto it = lower_bound(hotTitles.begin(), hotTitles.end(), *slot,
+                              [](const auto& entry, size_t s) { return entry.first < s; });
+        bool isHot = it != hotTitles.end() && it->first == *slot;
+        if (hot && !isHot) {
+            hotTitles.emplace(it, *slot, make_unique<HotStockCounter>(inventory[*slot].getQuantity(), shards));
+        } else if (!hot && isHot) {
+            settleHotLocked();
+            hotTitles.erase(it);
+        }
+        return true;
+    }
+
+    // Start counting units sold per title and keeping the bestseller ranking and the reorder list
+    // (titles with fewer than reorderThreshold copies) current, so topSellers and lowStock are instant.
+    // Sales made before this call are not counted. Call this before sharing the library between threads.
+    void enableSalesTracking(int reorderThreshold = 5) {
+        unique_lock lock(inventoryMutex);
+        lock_guard trackerLock(trackerMutex);
+        tracker = make_unique<SalesTracker>(reorderThreshold);
+        for (size_t slot = 0; slot < inventory.size(); slot++) {
+            tracker->addBook(quantityLocked(slot));
+        }
+    }
+
+    // Up to n (slot, units sold) pairs for the best-selling titles since enableSalesTracking, best
+    // first; titles with no sales are left out. Empty if tracking is off.
+    vector<pair<size_t, long long>> topSellers(size_t n) const {
+        shared_lock lock(inventoryMutex);
+        if (!tracker) {
+            return {};
+        }
+        lock_guard trackerLock(trackerMutex);
+        tracker->catchUp();
+        return tracker->topSellers(n);
+    }
+
+    // Units of the book at slot sold since enableSalesTracking (0 if tracking is off)
+    long long unitsSold(size_t slot) const {
+        shared_lock lock(inventoryMutex);
+        if (!tracker) {
+            return 0;
+        }
+        lock_guard trackerLock(trackerMutex);
+        tracker->catchUp();
+        return tracker->unitsSold(slot);
+    }
+
+    // Log every sale from now on (time, title, price, copies) in a compressed SalesHistory for the
+    // windowed sales queries below. With a file, earlier history is loaded from it and new sales are
+    // appended as blocks fill up. Call this before sharing the library between threads.
+    void enableSalesHistory(const string& file = "", size_t blockSales = 1 << 20) {
+        unique_lock lock(inventoryMutex);
+        history = make_unique<SalesHistory>(file, blockSales);
+    }
+
+    // Units and revenue of one title per bucketSeconds-long bucket of [from, to) (Unix seconds).
+    // Empty if the title is unknown or the history is off. Queries hold no inventory lock while
+    // they decode, so they never hold up sales.
+    vector<SalesTotals> titleSales(string_view title, int64_t from, int64_t to, int64_t bucketSeconds) const {
+        optional<size_t> slot = findBook(title);
+        if (!history || !slot) {
+            return {};
+        }
+        uint32_t id = static_cast<uint32_t>(*slot);
+        return history->histogram(from, to, bucketSeconds, span<const uint32_t>(&id, 1));
+    }
+
+    // Units and revenue of all titles by an author (case-insensitive), bucketed as titleSales
+    vector<SalesTotals> authorSales(string_view author, int64_t from, int64_t to, int64_t bucketSeconds) const {
+        vector<size_t> slots = findByAuthor(author);
+        if (!history || slots.empty()) {
+            return {};
+        }
+        vector<uint32_t> ids(slots.begin(), slots.end());  // Already in slot order
+        return history->histogram(from, to, bucketSeconds, ids);
+    }
+
+    // Units and revenue of the whole store, bucketed as titleSales
+    vector<SalesTotals> storeSales(int64_t from, int64_t to, int64_t bucketSeconds) const {
+        return history ? history->histogram(from, to, bucketSeconds) : vector<SalesTotals>{};
+    }
+
+    // Write sales still buffered in the history to its file
+    void flushSalesHistory() {
+        if (history) {
+            history->flush();
+        }
+    }
+
+    // Switch to asynchronous persistence: mutations mark their books dirty and return immediately,
+    // and a background writer saves them when interval passes or maxPending changes pile up.
+    // Call this before sharing the library between threads.
+    void enableAsyncPersistence(chrono::milliseconds interval = chrono::milliseconds(50), size_t maxPending = 4096) {
+        writer = make_unique<PersistenceWriter>(
+            [this](span<const size_t> slots) { writeChanges(slots); }, interval, maxPending);
+    }
+
+    // Durability barrier: returns once every earlier change has reached storage
+    void flush() {
+        if (writer) {
+            writer->flush();
+        }
     }
 
     // Get the library inventory
+    // The reference is only safe to use while no other thread is adding books; use snapshot() otherwise.
+    // Hot titles show the stock they had at the last save, snapshot or read through the library.
     const vector<Book>& getInventory() const { return inventory; }
 
     // Load inventory from a file
     void loadInventory(const string& filename) {
-        auto books = storage->loadFromFile(filename);
-        for (const auto& book : books) {
-            addBook(book);
+        ScopedLatency timer(Operation::LoadInventory);
+        lock_guard storageLock(storageMutex);
+        vector<Book> books;
+        {
+            ScopedLatency loadTimer(Operation::StorageLoad);
+            books = storage->loadFromFile(filename);
         }
-        storage->saveToFile(inventory, "inventory.txt");
+        {
+            unique_lock lock(inventoryMutex);
+            appendBooksLocked(std::move(books));
+        }
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        ScopedLatency saveTimer(Operation::StorageSave);
+        storage->saveToFile(inventory, storageFile);
     }
 
 private:
+    // Add a book; caller holds inventoryMutex exclusively
+    void addBookLocked(const Book& book) {
+        // The first copy of a title owns the index entry, matching the old first-match scan
+        titleIndex.emplace(book.getTitle(), inventory.size());
+        search.add(static_cast<uint32_t>(inventory.size()), book);
+        priceOrder.insert(book.getPriceCents(), static_cast<uint32_t>(inventory.size()));
+        inventory.push_back(book);
+        columns.append(book);
+        if (tracker) {
+            lock_guard trackerLock(trackerMutex);
+            tracker->addBook(book.getQuantity());
+        }
+    }
+
+    // Add many books at once, updating each index in a single pass; caller holds inventoryMutex exclusively
+    void appendBooksLocked(vector<Book> books) {
+        size_t first = inventory.size();
+        if (first == 0) {
+            inventory = std::move(books);  // Empty library: adopt the loaded vector as is
+        } else {
+            inventory.reserve(first + books.size());
+            move(books.begin(), books.end(), back_inserter(inventory));
+        }
+        titleIndex.reserve(inventory.size());
+        columns.reserve(inventory.size());
+        vector<SortedRunIndex<long long>::Entry> prices;
+        prices.reserve(inventory.size() - first);
+        for (size_t slot = first; slot < inventory.size(); slot++) {
+            titleIndex.emplace(inventory[slot].getTitle(), slot);
+            columns.append(inventory[slot]);
+            prices.emplace_back(inventory[slot].getPriceCents(), static_cast<uint32_t>(slot));
+        }
+        search.addRange(static_cast<uint32_t>(first), span<const Book>(inventory).subspan(first));
+        priceOrder.insertBulk(std::move(prices));
+        if (tracker) {
+            lock_guard trackerLock(trackerMutex);
+            for (size_t slot = first; slot < inventory.size(); slot++) {
+                tracker->addBook(inventory[slot].getQuantity());
+            }
+        }
+    }
+
+    // Resolve operations to (slot, net delta) in changes, one entry per title in slot order, so each
+    // book is checked against its total demand. Returns false if a title is missing; caller holds inventoryMutex.
+    bool resolveLocked(const vector<StockOperation>& operations, vector<pair<size_t, int>>& changes) const {
+        changes.clear();
+        changes.reserve(operations.size());
+        for (const auto& operation : operations) {
+            auto slot = findBookLocked(operation.title);
+            if (!slot) {
+                return false;
+            }
+            changes.emplace_back(*slot, operation.delta);
+        }
+        sort(changes.begin(), changes.end());
+        size_t merged = 0;
+        for (size_t i = 0; i < changes.size(); i++) {
+            if (merged > 0 && changes[merged - 1].first == changes[i].first) {
+                changes[merged - 1].second += changes[i].second;
+            } else {
+                changes[merged++] = changes[i];
+            }
+        }
+        changes.resize(merged);
+        return true;
+    }
+
+    // A batch changing several books under the shared lock, as snapshot() sees it (see batchEpoch).
+    // Create one before the first change and keep it until the last; if a snapshot is copying the
+    // quantities, the books' current quantities are recorded for it first.
+    class BatchScope {
+    public:
+        BatchScope(const Library& library, const vector<pair<size_t, int>>& changes) : library(library) {
+            while (true) {
+                epoch = library.batchEpoch.load();
+                library.batchesRunning[epoch & 1].fetch_add(1);
+                if (library.batchEpoch.load() == epoch) {
+                    break;
+                }
+                library.batchesRunning[epoch & 1].fetch_sub(1);  // A snapshot opened an epoch meanwhile
+            }
+            if (library.copyingEpoch.load() != epoch) {
+                return;
+            }
+            // The preimages must include every batch begun before the snapshot, so wait for those
+            while (library.drainedEpoch.load() != epoch && library.copyingEpoch.load() == epoch) {
+                this_thread::yield();
+            }
+            lock_guard preimageLock(library.preimageMutex);
+            if (library.copyingEpoch.load() == epoch) {
+                for (auto [slot, delta] : changes) {
+                    library.preimages.emplace_back(slot, library.quantityLocked(slot));
+                }
+            }
+        }
+
+        ~BatchScope() { library.batchesRunning[epoch & 1].fetch_sub(1); }
+
+        BatchScope(const BatchScope&) = delete;
+        BatchScope& operator=(const BatchScope&) = delete;
+
+    private:
+        const Library& library;
+        uint64_t epoch = 0;
+    };
+
+    // Take the copies sold by every negative delta, or none: if one book is short, give back what
+    // was already taken. Caller holds inventoryMutex.
+    bool takeAllLocked(const vector<pair<size_t, int>>& changes) {
+        for (size_t i = 0; i < changes.size(); i++) {
+            auto [slot, delta] = changes[i];
+            if (delta < 0 && !takeStock(slot, -delta)) {
+                Metrics::count(Counter::OutOfStock);
+                for (size_t j = 0; j < i; j++) {
+                    if (changes[j].second < 0) {
+                        addStock(changes[j].first, -changes[j].second);
+                    }
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Persist the books of a batch (one entry per slot) with a single storage call
+    void persistBatch(const vector<pair<size_t, int>>& changes) {
+        vector<size_t> slots;
+        slots.reserve(changes.size());
+        for (auto [slot, delta] : changes) {
+            slots.push_back(slot);
+        }
+        persistChanges(slots);
+    }
+
+    // Look up a title; caller holds inventoryMutex
+    optional<size_t> findBookLocked(string_view title) const {
+        auto it = titleIndex.find(title);
+        if (it == titleIndex.end()) {
+            Metrics::count(Counter::LookupMisses);
+            return nullopt;
+        }
+        Metrics::count(Counter::LookupHits);
+        return it->second;
+    }
+
+    // Take count copies of the book at slot, keeping the columns in step; caller holds inventoryMutex
+    bool takeStock(size_t slot, int count) {
+        if (HotStockCounter* hot = hotCounter(slot)) {
+            if (!hot->tryTake(count)) {
+                return false;
+            }
+        } else if (inventory[slot].tryTake(count)) {
+            columns.addQuantity(slot, -count);
+        } else {
+            return false;
+        }
+        trackStock(slot, -count);
+        return true;
+    }
+
+    // Add delta copies to the book at slot, keeping the columns in step; caller holds inventoryMutex
+    void addStock(size_t slot, int delta) {
+        if (HotStockCounter* hot = hotCounter(slot)) {
+            hot->add(delta);
+        } else {
+            inventory[slot].addQuantity(delta);
+            columns.addQuantity(slot, delta);
+        }
+        trackStock(slot, delta);
+    }
+
+    // Stock counter of a hot title, or nullptr; caller holds inventoryMutex
+    HotStockCounter* hotCounter(size_t slot) const {
+        if (hotTitles.empty()) {
+            return nullptr;
+        }
+        auto it = lower_bound(hotTitles.begin(), hotTitles.end(), slot,
+                              [](const auto& entry, size_t s) { return entry.first < s; });
+        return it != hotTitles.end() && it->first == slot ? it->second.get() : nullptr;
+    }
+
+    // Current stock of the book at slot, wherever it is kept; caller holds inventoryMutex
+    int quantityLocked(size_t slot) const {
+        HotStockCounter* hot = hotCounter(slot);
+        return hot ? hot->total() : inventory[slot].getQuantity();
+    }
+
+    // Tell the sales tracker (if on) the book's new stock after a change by delta; caller holds
+    // inventoryMutex. Only a change that starts or ends below the reorder threshold can move the book
+    // on the reorder list, so only those take trackerMutex. The quantity is read under the lock, so
+    // the last of several racing updates sees them all.
+    void trackStock(size_t slot, int delta) {
+        if (!tracker) {
+            return;
+        }
+        int quantity = quantityLocked(slot);
+        if (min(quantity, quantity - delta) < tracker->reorderThreshold()) {
+            lock_guard trackerLock(trackerMutex);
+            tracker->stockChanged(slot, quantityLocked(slot));
+        }
+    }
+
+    // Count copies of the book at slot as sold (tracking only) and log the sale in the sales history
+    // (if on) at the book's price; caller holds inventoryMutex
+    void trackSale(size_t slot, int count) {
+        if (tracker && tracker->notePending(slot, count)) {
+            lock_guard trackerLock(trackerMutex);
+            tracker->listPending(slot);
+        }
+        if (history && count > 0) {
+            int64_t now = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+            history->record(static_cast<uint32_t>(slot), now, inventory[slot].getPriceCents(), static_cast<uint32_t>(count));
+        }
+    }
+
+    // Copy the stock of hot titles into their Books and the quantity column before they are read.
+    // Caller holds inventoryMutex; under the shared lock the copy is as current as any live read.
+    // Const readers call this too; like Book::stock, the quantities are written through atomic_ref.
+    void settleHotLocked() const {
+        for (const auto& [slot, counter] : hotTitles) {
+            int quantity = counter->total();
+            const_cast<Book&>(inventory[slot]).setQuantity(quantity);
+            const_cast<InventoryColumns&>(columns).setQuantity(slot, quantity);
+        }
+    }
+
+    // Hand a single stock change to storage; journaling backends record just this book
+    void persistChange(size_t slot) {
+        persistChanges(span<const size_t>(&slot, 1));
+    }
+
+    // Hand a group of stock changes to storage in one call, or to the background writer if enabled
+    void persistChanges(span<const size_t> slots) {
+        if (writer) {
+            writer->markDirty(slots);
+            return;
+        }
+        writeChanges(slots);
+    }
+
+    // Write stock changes to storage now
+    void writeChanges(span<const size_t> slots) {
+        lock_guard storageLock(storageMutex);
+        shared_lock lock(inventoryMutex);
+        settleHotLocked();
+        ScopedLatency timer(Operation::StorageChanges);
+        storage->saveChanges(inventory, slots, storageFile);
+    }
+
     vector<Book> inventory;  // Collection of books in the library
+    unordered_map<string, size_t, TitleHash, equal_to<>> titleIndex;  // Title -> inventory slot
+    SearchIndex search;  // Prefix, author and keyword search over titles and authors
+    SortedRunIndex<long long> priceOrder;  // Price in cents -> slot, ordered, for price range queries
+    // Price and quantity columns for whole-inventory scans. Sales update them under the shared lock,
+    // so a scan running alongside sales may miss changes still in flight, like any snapshot-free read.
+    InventoryColumns columns;
     unique_ptr<FileStorageBase> storage;  // Storage mechanism (local or cloud)
+    string storageFile;  // File that changes are saved to
+    mutable shared_mutex inventoryMutex;  // Guards the shape of inventory and titleIndex
+    // Hot titles by slot, sorted; only setHotTitle changes the list, under the exclusive lock
+    vector<pair<size_t, unique_ptr<HotStockCounter>>> hotTitles;
+    unique_ptr<SalesTracker> tracker;  // Bestsellers and reorder list (enableSalesTracking only)
+    mutable mutex trackerMutex;  // Guards tracker's contents; taken after inventoryMutex
+    unique_ptr<SalesHistory> history;  // Every sale, time-stamped (enableSalesHistory only)
+    mutable mutex snapshotMutex;  // Serializes snapshot(); taken before inventoryMutex
+    // Batches (several books changed as one step) and snapshot() meet through epochs instead of the
+    // exclusive lock. A snapshot opens a new epoch and waits only for the batches of the previous one
+    // (counted by epoch parity). Batches of the new epoch wait for that too, then record the quantity
+    // of each book they change (a preimage) until the snapshot's copy is done. Single-book changes
+    // need neither: each is one atomic step that the copy sees or does not.
+    mutable atomic<uint64_t> batchEpoch{1};  // Starts above 0, which copyingEpoch uses for none
+    mutable atomic<int> batchesRunning[2]{};  // Batches in flight, by the parity of their epoch
+    mutable atomic<uint64_t> copyingEpoch{0};  // Epoch whose snapshot wants preimages, or 0
+    mutable atomic<uint64_t> drainedEpoch{0};  // Latest epoch whose earlier batches have all finished
+    mutable mutex preimageMutex;  // Guards preimages; taken after inventoryMutex
+    mutable vector<pair<size_t, int>> preimages;  // (slot, quantity before a batch changed it)
+    mutable SnapshotCatalog snapshotCatalog;  // Catalog shared by snapshots; guarded by snapshotMutex
+    mutex storageMutex;  // Serializes storage calls
+    // Background writer (asynchronous mode only). Declared last so it is destroyed first and
+    // flushes pending changes while storage and inventory are still alive.
+    unique_ptr<PersistenceWriter> writer;
 };
 
 
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <csignal>
+#include "library.h"
+#include "journalstorage.h"
+#include "libraryserver.h"
+#include "inventorylock.h"
+#include "sharedinventory.h"
+using namespace std;
+
+static LibraryServer* runningServer = nullptr;
+
+static void handleSignal(int)
+{
+    if (runningServer) {
+        runningServer->stop();
+    }
+}
+
+// Keep one Library resident and serve it over a Unix-domain socket until SIGINT or SIGTERM.
+// Usage: library_server [inventory file] [socket path]   (defaults: inventory.txt /tmp/library.sock)
+int main(int argc, char* argv[])
+{
+    string inventoryFile = argc > 1 ? argv[1] : "inventory.txt";
+    string socketPath = argc > 2 ? argv[2] : "/tmp/library.sock";
+
+    // The server journals stock for as long as it runs, so no other program may write the file meanwhile
+    InventoryLock lock(inventoryFile, InventoryLock::Mode::Exclusive);
+    if (!lock.held() || SharedInventory::terminalSegmentBlocks()) {
+        return 1;
+    }
+
+    // Sales are journaled and written in the background, so requests never wait on the disk
+    Library library(make_unique<JournaledFileStorage>(), inventoryFile);
+    library.loadInventory(inventoryFile);
+    library.enableAsyncPersistence();
+
+    LibraryServer server(library, socketPath);
+    if (!server.start()) {
+        return 1;
+    }
+    runningServer = &server;
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    cout << "Serving " << library.getInventory().size() << " books on " << socketPath << endl;
+    server.run();
+    runningServer = nullptr;
+
+    library.flush();
+    cout << "Server stopped" << endl;
+    return 0;
+}
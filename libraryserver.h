@@ -0,0 +1,367 @@
+#ifndef LIBRARYSERVER_H
+#define LIBRARYSERVER_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "library.h"
+using namespace std;
+
+// LibraryServer Class: Serves one resident Library to many clients over a Unix-domain socket
+// Protocol: one request per line, one response line per request, in request order.
+//   BUY <title>             -> OK | ERR not found | ERR out of stock
+//   RESTOCK <count> <title> -> OK | ERR not found   (count > 0)
+//   LOOKUP <title>          -> OK <price> <quantity> <author> | ERR not found
+//   SEARCH <words>          -> OK <count>[\t<title>]... (up to 20 keyword matches)
+//   PING                    -> OK
+// A single epoll loop owns every connection. Clients may pipeline any number of requests; each
+// loop pass parses the complete lines from all readable connections and applies all their BUY and
+// RESTOCK requests together through Library::applyEach, so a burst of sales costs one storage call.
+// A LOOKUP or SEARCH that follows a BUY or RESTOCK on the same connection applies the queued stock
+// changes first, so every response reflects the requests before it. A client that keeps sending
+// without reading its responses is not read from again until most of them have gone out.
+class LibraryServer {
+public:
+    LibraryServer(Library& library, string socketPath) : library(library), socketPath(std::move(socketPath)) {}
+
+    ~LibraryServer() {
+        for (auto& [fd, connection] : connections) {
+            close(fd);
+        }
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+        if (wakeFd >= 0) {
+            close(wakeFd);
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+    }
+
+    LibraryServer(const LibraryServer&) = delete;
+    LibraryServer& operator=(const LibraryServer&) = delete;
+
+    // Create the socket and the event loop; returns false (after printing why) if that fails
+    bool start() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            cerr << "Socket path too long: " << socketPath << endl;
+            return false;
+        }
+        memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        unlink(socketPath.c_str());  // A stale socket from an earlier run would make bind fail
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (listenFd < 0 || epollFd < 0 || wakeFd < 0
+            || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listenFd, SOMAXCONN) != 0) {
+            cerr << "Error starting server on " << socketPath << ": " << strerror(errno) << endl;
+            return false;
+        }
+        watch(listenFd, EPOLLIN);
+        watch(wakeFd, EPOLLIN);
+        return true;
+    }
+
+    // Serve requests until stop() is called
+    void run() {
+        vector<epoll_event> events(256);
+        vector<int> readable;
+        while (!stopping) {
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                cerr << "epoll_wait failed: " << strerror(errno) << endl;
+                return;
+            }
+            readable.clear();
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptClients();
+                } else if (fd == wakeFd) {
+                    stopping = true;
+                } else {
+                    if (events[i].events & EPOLLOUT) {
+                        sendPending(fd);
+                    }
+                    if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                        readable.push_back(fd);
+                    }
+                }
+            }
+            serve(readable);
+        }
+    }
+
+    // Ask run() to return; safe to call from another thread or a signal handler
+    void stop() {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = write(wakeFd, &one, sizeof(one));
+    }
+
+private:
+    struct Connection {
+        string input;   // Bytes received but not yet parsed
+        string output;  // Responses not yet sent
+        size_t sent = 0;  // Bytes of output already sent
+        uint32_t watched = EPOLLIN | EPOLLRDHUP;  // Events epoll reports for this connection
+        bool closing = false;  // Peer is gone or misbehaved
+        bool stockPending = false;  // Sent a BUY or RESTOCK that has not been applied yet
+    };
+
+    // A parsed request waiting for its response
+    struct Request {
+        int fd;
+        string response;
+        size_t stockOperation = SIZE_MAX;  // Index into the pass's stock operations, for BUY and RESTOCK
+    };
+
+    // Requests parsed in one loop pass. Stock operations queue up until applyPending runs them;
+    // firstPending is the first request whose operation may still be queued.
+    struct Pass {
+        vector<Request> requests;
+        vector<StockOperation> stockOperations;
+        size_t firstPending = 0;
+    };
+
+    static constexpr size_t kMaxLine = 1 << 16;  // Longer requests close the connection
+    static constexpr size_t kMaxOutput = 1 << 20;  // Unsent responses above this pause reading requests
+    static constexpr size_t kSearchLimit = 20;
+
+    void watch(int fd, uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;  // EAGAIN: accepted everything pending
+            }
+            watch(fd, EPOLLIN | EPOLLRDHUP);
+            connections.emplace(fd, Connection());
+        }
+    }
+
+    // Read, parse and answer everything the readable connections have sent
+    void serve(const vector<int>& readable) {
+        Pass pass;
+        for (int fd : readable) {
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& connection = it->second;
+            receive(fd, connection);
+            parse(fd, connection, pass);
+        }
+        applyPending(pass);
+
+        for (auto& request : pass.requests) {
+            connections[request.fd].output += request.response;
+        }
+        for (int fd : readable) {
+            auto it = connections.find(fd);
+            if (it != connections.end()) {
+                sendPending(fd);
+            }
+        }
+    }
+
+    // Apply the queued stock operations with one applyEach call and fill in their responses
+    void applyPending(Pass& pass) {
+        if (pass.stockOperations.empty()) {
+            return;
+        }
+        vector<bool> applied = library.applyEach(pass.stockOperations);
+        for (size_t i = pass.firstPending; i < pass.requests.size(); i++) {
+            Request& request = pass.requests[i];
+            if (request.stockOperation == SIZE_MAX) {
+                continue;
+            }
+            connections[request.fd].stockPending = false;
+            const StockOperation& operation = pass.stockOperations[request.stockOperation];
+            if (applied[request.stockOperation]) {
+                request.response = "OK\n";
+            } else if (operation.delta < 0 && library.findBook(operation.title)) {
+                request.response = "ERR out of stock\n";
+            } else {
+                request.response = "ERR not found\n";
+            }
+            request.stockOperation = SIZE_MAX;
+        }
+        pass.stockOperations.clear();
+        pass.firstPending = pass.requests.size();
+    }
+
+    void receive(int fd, Connection& connection) {
+        char buffer[1 << 16];
+        while (true) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                connection.input.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                connection.closing = true;  // Answer what was received, then close
+            }
+            if (n == 0 || errno != EINTR) {
+                return;
+            }
+        }
+    }
+
+    // Turn every complete line into a request; lookups are answered at once, stock changes deferred
+    void parse(int fd, Connection& connection, Pass& pass) {
+        string_view input = connection.input;
+        size_t consumed = 0;
+        while (true) {
+            size_t end = input.find('\n', consumed);
+            if (end == string_view::npos) {
+                break;
+            }
+            string_view line = input.substr(consumed, end - consumed);
+            consumed = end + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            Request request{fd, {}};
+            handle(line, request, connection, pass);
+            pass.requests.push_back(std::move(request));
+        }
+        connection.input.erase(0, consumed);
+        if (connection.input.size() > kMaxLine) {
+            connection.closing = true;
+        }
+    }
+
+    void handle(string_view line, Request& request, Connection& connection, Pass& pass) {
+        size_t space = line.find(' ');
+        string_view command = line.substr(0, space);
+        string_view argument = space == string_view::npos ? string_view() : line.substr(space + 1);
+        if ((command == "LOOKUP" || command == "SEARCH") && connection.stockPending) {
+            applyPending(pass);  // Reads see this connection's earlier BUY and RESTOCK requests
+        }
+
+        if (command == "BUY") {
+            request.stockOperation = pass.stockOperations.size();
+            pass.stockOperations.push_back({string(argument), -1});
+            connection.stockPending = true;
+        } else if (command == "RESTOCK") {
+            int count = 0;
+            auto [ptr, ec] = from_chars(argument.data(), argument.data() + argument.size(), count);
+            if (ec != errc() || count <= 0 || ptr == argument.data() + argument.size() || *ptr != ' ') {
+                request.response = "ERR usage: RESTOCK <count> <title>\n";
+                return;
+            }
+            string_view title = argument.substr(ptr - argument.data() + 1);
+            request.stockOperation = pass.stockOperations.size();
+            pass.stockOperations.push_back({string(title), count});
+            connection.stockPending = true;
+        } else if (command == "LOOKUP") {
+            auto slot = library.findBook(argument);
+            if (!slot) {
+                request.response = "ERR not found\n";
+                return;
+            }
+            library.readBook(*slot, [&](const Book& book) {
+                request.response = "OK " + formatPrice(book.getPriceCents()) + " " + to_string(book.getQuantity())
+                    + " " + book.getAuthor() + "\n";
+            });
+        } else if (command == "SEARCH") {
+            vector<size_t> slots = library.searchKeywords(argument, kSearchLimit);
+            request.response = "OK " + to_string(slots.size());
+            for (size_t slot : slots) {
+                request.response += '\t';
+                library.readBook(slot, [&](const Book& book) { request.response += book.getTitle(); });
+            }
+            request.response += '\n';
+        } else if (command == "PING") {
+            request.response = "OK\n";
+        } else {
+            request.response = "ERR unknown command\n";
+        }
+    }
+
+    static string formatPrice(long long cents) {
+        string text = to_string(cents / 100) + ".";
+        int fraction = static_cast<int>(cents % 100);
+        text += static_cast<char>('0' + fraction / 10);
+        text += static_cast<char>('0' + fraction % 10);
+        return text;
+    }
+
+    // Write as much queued output as the socket takes; watch for EPOLLOUT if some is left
+    void sendPending(int fd) {
+        Connection& connection = connections[fd];
+        bool broken = false;
+        while (connection.sent < connection.output.size()) {
+            ssize_t n = send(fd, connection.output.data() + connection.sent, connection.output.size() - connection.sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                broken = errno != EAGAIN;
+                break;
+            }
+            connection.sent += static_cast<size_t>(n);
+        }
+        bool drained = connection.sent == connection.output.size();
+        if (drained) {
+            connection.output.clear();
+            connection.sent = 0;
+        } else if (connection.sent > kMaxOutput) {
+            connection.output.erase(0, connection.sent);  // A slow reader that never quite drains
+            connection.sent = 0;
+        }
+        if (broken || (connection.closing && drained)) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            connections.erase(fd);
+            return;
+        }
+        // Watch for writability while output is left, and stop reading from a client that sends
+        // requests without reading the responses until its backlog is back under kMaxOutput
+        bool backedUp = connection.output.size() - connection.sent > kMaxOutput;
+        uint32_t wanted = (drained ? 0 : EPOLLOUT) | (backedUp ? 0 : EPOLLIN | EPOLLRDHUP);
+        if (wanted != connection.watched) {
+            epoll_event event{};
+            event.events = wanted;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+            connection.watched = wanted;
+        }
+    }
+
+    Library& library;
+    string socketPath;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;  // eventfd written by stop()
+    bool stopping = false;
+    unordered_map<int, Connection> connections;
+};
+
+#endif // LIBRARYSERVER_H
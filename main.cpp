@@ -4,6 +4,9 @@
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
 using namespace std;
 
 // Book Class: Adheres to the Single Responsibility Principle (SRP)
@@ -116,6 +119,13 @@ public:
     }
 };
 
+// TitleHash: Transparent hash for the title index
+// Lets the index be probed with a string_view, so a lookup never allocates a temporary string.
+struct TitleHash {
+    using is_transparent = void;
+    size_t operator()(string_view title) const { return hash<string_view>{}(title); }
+};
+
 // Library Class: Adheres to the Liskov Substitution Principle (LSP)
 // Can be used interchangeably with the InventoryManager interface.
 class Library : public InventoryManager {
@@ -125,6 +135,8 @@ public:
 
     // Add a book to the library inventory
     void addBook(const Book& book) override {
+        // The first copy of a title owns the index entry, matching the old first-match scan
+        titleIndex.emplace(book.getTitle(), inventory.size());
         inventory.push_back(book);
     }
 
@@ -136,27 +148,44 @@ public:
         }
     }
 
+    // Find the inventory slot of a book by title (no allocation per probe)
+    optional<size_t> findBook(string_view title) const {
+        auto it = titleIndex.find(title);
+        if (it == titleIndex.end()) {
+            return nullopt;
+        }
+        return it->second;
+    }
+
+    // Get the book stored at an inventory slot returned by findBook
+    const Book& getBook(size_t slot) const { return inventory[slot]; }
+
     // Update the stock of a book
     bool updateStock(const string& title, int quantity) override {
-        for (auto& book : inventory) {
-            if (book.getTitle() == title) {
-                book.setQuantity(book.getQuantity() + quantity);
-                return true;
-            }
+        auto slot = findBook(title);
+        if (!slot) {
+            return false;
         }
-        return false;
+        Book& book = inventory[*slot];
+        book.setQuantity(book.getQuantity() + quantity);
+        return true;
     }
 
     // Sell a book from the library
-    bool sellBook(const string& title) {
-        for (auto& book : inventory) {
-            if (book.getTitle() == title && book.getQuantity() > 0) {
-                book.setQuantity(book.getQuantity() - 1);
-                storage->saveToFile(inventory, "inventory.txt");  // Save changes to storage
-                return true;
-            }
+    bool sellBook(string_view title) {
+        auto slot = findBook(title);
+        return slot && sellBookAt(*slot);
+    }
+
+    // Sell the book at a slot already resolved through findBook
+    bool sellBookAt(size_t slot) {
+        Book& book = inventory[slot];
+        if (book.getQuantity() <= 0) {
+            return false;
         }
-        return false;
+        book.setQuantity(book.getQuantity() - 1);
+        storage->saveToFile(inventory, "inventory.txt");  // Save changes to storage
+        return true;
     }
 
     // Get the library inventory
@@ -165,6 +194,8 @@ public:
     // Load inventory from a file
     void loadInventory(const string& filename) {
         auto books = storage->loadFromFile(filename);
+        inventory.reserve(inventory.size() + books.size());
+        titleIndex.reserve(inventory.size() + books.size());
         for (const auto& book : books) {
             addBook(book);
         }
@@ -173,6 +204,7 @@ public:
 
 private:
     vector<Book> inventory;  // Collection of books in the library
+    unordered_map<string, size_t, TitleHash, equal_to<>> titleIndex;  // Title -> inventory slot
     unique_ptr<FileStorageBase> storage;  // Storage mechanism (local or cloud)
 };
 
@@ -210,20 +242,21 @@ public:
 
     // Buy a book from the library
     bool buyBook(Library& library, const string& title) {
-        for (const auto& book : library.getInventory()) {
-            if (book.getTitle() == title) {
-                if (paymentMethod->processPayment(book.getPrice())) {
-                    if (library.sellBook(title)) {
-                        cout << name << " bought " << title << endl;
-                        return true;
-                    } else {
-                        cout << "Book out of stock!" << endl;
-                    }
-                }
-            }
+        // Resolve the title once; payment and sale both work on the same slot
+        auto slot = library.findBook(title);
+        if (!slot) {
+            cout << "Book not found in inventory!" << endl;
+            return false;
         }
-        cout << "Book not found in inventory!" << endl;
-        return false;
+        if (!paymentMethod->processPayment(library.getBook(*slot).getPrice())) {
+            return false;
+        }
+        if (!library.sellBookAt(*slot)) {
+            cout << "Book out of stock!" << endl;
+            return false;
+        }
+        cout << name << " bought " << title << endl;
+        return true;
     }
 
 private:
@@ -4,72 +4,85 @@
 #include <memory>
 #include <fstream>
 #include <sstream>
-#include "Library.h"
+#include "library.h"
+#include "journalstorage.h"
+#include "payment.h"
+#include "customer.h"
+#include "sharedinventory.h"
+#include "inventorylock.h"
 // #include "filestorage.h"
 // #include"book.h"
 // #include "inventoryy.h"
 using namespace std;
 
-
-// Payment Interface: Adheres to the Dependency Inversion Principle (DIP)
-// High-level modules depend on abstractions, not concrete implementations.
-class Payment {
-public:
-    virtual bool processPayment(double amount) = 0;  // Process a payment
-    virtual ~Payment() = default;  // Virtual destructor
-};
-
-// CashPayment Class: Implements the Payment interface for cash payments
-class CashPayment : public Payment {
-public:
-    bool processPayment(double amount) override {
-        cout << "Processing cash payment of $" << amount << endl;
-        return true;
+// Terminal sharing one inventory with every other --shared terminal on this host.
+// The first terminal loads inventory.txt into shared memory; later ones attach without loading.
+// The first to attach takes persistence and keeps it until it exits, saving every terminal's sales;
+// a terminal finishing after it takes over. The last terminal to leave removes the segment, so
+// the next session loads the file again.
+static int runSharedTerminal(FileStorageBase& fileStorage, shared_ptr<Payment> payment) {
+    // Shared with the other --shared terminals; keeps the server and other writers off the file
+    InventoryLock lock("inventory.txt", InventoryLock::Mode::Shared);
+    if (!lock.held()) {
+        return 1;
     }
-};
-
-// OnlinePayment Class: Implements the Payment interface for online payments
-class OnlinePayment : public Payment {
-public:
-    bool processPayment(double amount) override {
-        cout << "Processing online payment of $" << amount << endl;
-        return true;
+    auto inventory = SharedInventory::openOrLoad(SharedInventory::kTerminalSegment, fileStorage, "inventory.txt");
+    if (!inventory) {
+        return 1;
     }
-};
-
-// Customer Class: Manages customer interactions with the library
-class Customer {
-public:
-    // Constructor to initialize customer with a payment method
-    Customer(const string& name, shared_ptr<Payment> paymentMethod) : name(name), paymentMethod(paymentMethod) {}
-
-    // Buy a book from the library
-    bool buyBook(Library& library, const string& title) {
-        for (const auto& book : library.getInventory()) {
-            if (book.getTitle() == title) {
-                if (paymentMethod->processPayment(book.getPrice())) {
-                    if (library.sellBook(title)) {
-                        cout << name << " bought " << title << endl;
-                        return true;
-                    } else {
-                        cout << "Book out of stock!" << endl;
-                    }
-                }
-            }
+    inventory->claimPersistence();  // Fails if a live terminal already owns it
+    string name,title;
+    cout<<"enter your name: ";
+    std::getline(std::cin,name);
+    cout<<"welcome to library! "<<name<<endl;
+    const size_t pageSize = 10;
+    size_t page = 0;
+    while (true) {
+        cout << "Current Inventory (page " << page + 1 << "):\n";
+        size_t shown = inventory->exportInventory(cout, {.offset = page * pageSize, .limit = pageSize});
+        cout<<"enter book you want to buy (or press enter for the next page): ";
+        if (!std::getline(std::cin,title) || !title.empty()) {
+            break;
         }
+        page = shown < pageSize ? 0 : page + 1;
+    }
+
+    // Take the copy before charging, as Customer::buyBook does, and put it back if payment fails
+    auto slot = inventory->findBook(title);
+    if (!slot) {
         cout << "Book not found in inventory!" << endl;
-        return false;
+    } else if (!inventory->sellBookAt(*slot)) {
+        cout << "Book out of stock!" << endl;
+    } else if (!payment->processPayment(inventory->getBook(*slot).getPrice())) {
+        inventory->updateStock(title, 1);
+    } else {
+        cout << name << " bought " << title << endl;
+    }
+    if (inventory->claimPersistence()) {
+        inventory->saveIfChanged(fileStorage, "inventory.txt");
+    }
+    // Nobody else holds the lock once the other terminals have gone, so nothing is left to save
+    if (lock.tryUpgrade()) {
+        SharedInventory::remove(SharedInventory::kTerminalSegment);
     }
+    cout<<"\nthank you for visiting!!";
+    return 0;
+}
 
-private:
-    string name;  // Customer name
-    shared_ptr<Payment> paymentMethod;  // Payment method
-};
+int main(int argc, char* argv[]) {
+    // Create a unique pointer to file storage (sales are journaled instead of rewriting the file)
+    unique_ptr<FileStorageBase> fileStorage = make_unique<JournaledFileStorage>();
 
-int main() {
-    // Create a unique pointer to file storage
-    unique_ptr<FileStorageBase> fileStorage = make_unique<FileStorageFromFile>();
+    // --shared: sell from the inventory shared by all terminals on this host
+    if (argc > 1 && string(argv[1]) == "--shared") {
+        return runSharedTerminal(*fileStorage, make_shared<CashPayment>());
+    }
 
+    // No other program may journal or compact inventory.txt while this terminal does
+    InventoryLock lock("inventory.txt", InventoryLock::Mode::Exclusive);
+    if (!lock.held() || SharedInventory::terminalSegmentBlocks()) {
+        return 1;
+    }
     Library library(move(fileStorage));
 
     // Load inventory from file
@@ -83,10 +96,18 @@ int main() {
     cout<<"enter your name: ";
     std::getline(std::cin,name);
     cout<<"welcome to library! "<<name<<endl;
-    cout << "Current Inventory:\n";
-    library.displayInventory();
-    cout<<"enter book you want to buy: ";
-    std::getline(std::cin,title);
+    // Show the inventory a page at a time until the customer names a book
+    const size_t pageSize = 10;
+    size_t page = 0;
+    while (true) {
+        cout << "Current Inventory (page " << page + 1 << "):\n";
+        size_t shown = library.exportInventory(cout, {.offset = page * pageSize, .limit = pageSize});
+        cout<<"enter book you want to buy (or press enter for the next page): ";
+        if (!std::getline(std::cin,title) || !title.empty()) {
+            break;
+        }
+        page = shown < pageSize ? 0 : page + 1;  // Wrap around after the last page
+    }
     
 
     Customer customer(name, payment);
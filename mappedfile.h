@@ -0,0 +1,66 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// MappedFile Class: Read-only memory mapping of a whole file (POSIX)
+// Lets loaders parse a file in place instead of copying it line by line into strings.
+class MappedFile {
+public:
+    explicit MappedFile(const string& filename) {
+        fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            fd = -1;
+            return;
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length == 0) {
+            return;  // Nothing to map; data() is an empty view
+        }
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            fd = -1;
+            length = 0;
+            return;
+        }
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        base = static_cast<const char*>(mapped);
+    }
+
+    ~MappedFile() {
+        if (base) {
+            munmap(const_cast<char*>(base), length);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Whether the file could be opened (an empty file is open but has no data)
+    bool isOpen() const { return fd >= 0; }
+
+    // The file contents; valid while this object lives
+    string_view data() const { return string_view(base ? base : "", length); }
+
+private:
+    int fd = -1;  // Open descriptor, -1 when the file could not be opened
+    const char* base = nullptr;  // Start of the mapping
+    size_t length = 0;  // File size in bytes
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,294 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <memory>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <bit>
+#include <cstdint>
+using namespace std;
+
+// Operation metrics are compiled in only when LMS_ENABLE_METRICS is defined (-DLMS_ENABLE_METRICS).
+// Without it every recording call below is an empty inline function and the timers never read the clock.
+#ifdef LMS_ENABLE_METRICS
+constexpr bool kMetricsEnabled = true;
+#else
+constexpr bool kMetricsEnabled = false;
+#endif
+
+// Timed operations
+enum class Operation {
+    SellBook,        // Library::sellBookAt (including the storage write when synchronous)
+    UpdateStock,     // Library::updateStock
+    ApplyBatch,      // Library::applyBatch
+    LoadInventory,   // Library::loadInventory (load, index and re-save)
+    StorageLoad,     // FileStorageBase::loadFromFile, any backend
+    StorageSave,     // FileStorageBase::saveToFile, any backend
+    StorageChanges,  // FileStorageBase::saveChanges, any backend
+    Payment,         // Payment::processPayment, or an asynchronous payment from start to answer
+    Count
+};
+
+// Event counters
+enum class Counter {
+    LookupHits,    // Title lookups that found a book
+    LookupMisses,  // Title lookups that found nothing
+    OutOfStock,    // Sales refused for lack of stock
+    BytesRead,     // Bytes read by storage backends
+    BytesWritten,  // Bytes written by storage backends
+    Count
+};
+
+inline const char* operationName(Operation op) {
+    static const char* names[] = {"sellBook", "updateStock", "applyBatch", "loadInventory",
+                                  "storageLoad", "storageSave", "storageChanges", "payment"};
+    return names[static_cast<size_t>(op)];
+}
+
+inline const char* counterName(Counter counter) {
+    static const char* names[] = {"lookupHits", "lookupMisses", "outOfStock", "bytesRead", "bytesWritten"};
+    return names[static_cast<size_t>(counter)];
+}
+
+// LatencyHistogram: HDR-style log-linear histogram of nanosecond latencies
+// Each power of two is split into 8 sub-buckets, so any recorded value is known to within 12.5%
+// across the full range from 1 ns to hours, in a fixed 4 KB.
+struct LatencyHistogram {
+    static constexpr int kSubBits = 3;
+    static constexpr size_t kSubBuckets = 1 << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    // Bucket of a value: exact below 8, then (power of two, next three bits)
+    static size_t bucketOf(uint64_t value) {
+        if (value < kSubBuckets) {
+            return value;
+        }
+        int exponent = bit_width(value) - 1 - kSubBits;
+        return (exponent + 1) * kSubBuckets + ((value >> exponent) & (kSubBuckets - 1));
+    }
+
+    // Smallest value that lands in a bucket
+    static uint64_t bucketFloor(size_t bucket) {
+        if (bucket < kSubBuckets) {
+            return bucket;
+        }
+        int exponent = static_cast<int>(bucket / kSubBuckets) - 1;
+        return (kSubBuckets + bucket % kSubBuckets) << exponent;
+    }
+
+    array<uint64_t, kBuckets> counts{};
+    uint64_t total = 0;  // Number of samples
+    uint64_t sum = 0;    // Sum of samples, ns
+    uint64_t max = 0;    // Largest sample, ns
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBuckets; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        max = std::max(max, other.max);
+    }
+
+    // Value at quantile q (0..1), reported as the floor of its bucket
+    uint64_t percentile(double q) const {
+        uint64_t rank = static_cast<uint64_t>(q * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            seen += counts[i];
+            if (seen > rank) {
+                return bucketFloor(i);
+            }
+        }
+        return max;
+    }
+};
+
+// MetricsSnapshot: Totals across all threads at one moment
+struct MetricsSnapshot {
+    array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+    array<LatencyHistogram, static_cast<size_t>(Operation::Count)> latencies{};
+
+    uint64_t counter(Counter c) const { return counters[static_cast<size_t>(c)]; }
+    const LatencyHistogram& latency(Operation op) const { return latencies[static_cast<size_t>(op)]; }
+
+    // One JSON object: {"counters":{...},"operations":{"sellBook":{"count":..,"p50_ns":..},...}}
+    void print(ostream& out) const {
+        out << "{\"counters\":{";
+        for (size_t c = 0; c < counters.size(); c++) {
+            out << (c ? "," : "") << "\"" << counterName(static_cast<Counter>(c)) << "\":" << counters[c];
+        }
+        out << "},\"operations\":{";
+        bool first = true;
+        for (size_t op = 0; op < latencies.size(); op++) {
+            const LatencyHistogram& h = latencies[op];
+            if (h.total == 0) {
+                continue;
+            }
+            out << (first ? "" : ",") << "\"" << operationName(static_cast<Operation>(op)) << "\":{"
+                << "\"count\":" << h.total << ",\"mean_ns\":" << h.sum / h.total
+                << ",\"p50_ns\":" << h.percentile(0.50) << ",\"p90_ns\":" << h.percentile(0.90)
+                << ",\"p99_ns\":" << h.percentile(0.99) << ",\"p999_ns\":" << h.percentile(0.999)
+                << ",\"max_ns\":" << h.max << "}";
+            first = false;
+        }
+        out << "}}" << endl;
+    }
+};
+
+// Metrics Class: Process-wide registry of per-thread metric blocks
+// Each thread records into its own block with plain relaxed stores (no shared cache lines, no
+// read-modify-write), and a snapshot sums every block. Blocks of finished threads are kept, so
+// their counts stay in the totals.
+class Metrics {
+public:
+    static void count(Counter counter, uint64_t n = 1) {
+        if constexpr (kMetricsEnabled) {
+            bump(local().counters[static_cast<size_t>(counter)], n);
+        }
+    }
+
+    static void recordLatency(Operation op, uint64_t nanoseconds) {
+        if constexpr (kMetricsEnabled) {
+            ThreadBlock::Histogram& h = local().latencies[static_cast<size_t>(op)];
+            bump(h.counts[LatencyHistogram::bucketOf(nanoseconds)], 1);
+            bump(h.total, 1);
+            bump(h.sum, nanoseconds);
+            if (nanoseconds > h.max.load(memory_order_relaxed)) {
+                h.max.store(nanoseconds, memory_order_relaxed);
+            }
+        }
+    }
+
+    // Current totals (all zero when metrics are compiled out)
+    static MetricsSnapshot snapshot() {
+        MetricsSnapshot result;
+        if constexpr (kMetricsEnabled) {
+            lock_guard lock(registry().lock);
+            for (const auto& block : registry().blocks) {
+                for (size_t c = 0; c < result.counters.size(); c++) {
+                    result.counters[c] += block->counters[c].load(memory_order_relaxed);
+                }
+                for (size_t op = 0; op < result.latencies.size(); op++) {
+                    const ThreadBlock::Histogram& from = block->latencies[op];
+                    LatencyHistogram& to = result.latencies[op];
+                    for (size_t i = 0; i < LatencyHistogram::kBuckets; i++) {
+                        to.counts[i] += from.counts[i].load(memory_order_relaxed);
+                    }
+                    to.total += from.total.load(memory_order_relaxed);
+                    to.sum += from.sum.load(memory_order_relaxed);
+                    to.max = max(to.max, from.max.load(memory_order_relaxed));
+                }
+            }
+        }
+        return result;
+    }
+
+    // Print the current totals as one JSON line
+    static void dump(ostream& out) {
+        if constexpr (kMetricsEnabled) {
+            snapshot().print(out);
+        }
+    }
+
+private:
+    struct ThreadBlock {
+        struct Histogram {
+            array<atomic<uint64_t>, LatencyHistogram::kBuckets> counts{};
+            atomic<uint64_t> total{0};
+            atomic<uint64_t> sum{0};
+            atomic<uint64_t> max{0};
+        };
+        array<atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters{};
+        array<Histogram, static_cast<size_t>(Operation::Count)> latencies{};
+    };
+
+    struct Registry {
+        mutex lock;
+        vector<unique_ptr<ThreadBlock>> blocks;
+    };
+
+    static Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    // Only the owning thread writes a block, so a load and a store are enough
+    static void bump(atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+
+    static ThreadBlock& local() {
+        thread_local ThreadBlock* block = [] {
+            lock_guard lock(registry().lock);
+            registry().blocks.push_back(make_unique<ThreadBlock>());
+            return registry().blocks.back().get();
+        }();
+        return *block;
+    }
+};
+
+// ScopedLatency: Records the time from construction to destruction under an operation
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Operation op) : op(op) {
+        if constexpr (kMetricsEnabled) {
+            start = chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedLatency() {
+        if constexpr (kMetricsEnabled) {
+            Metrics::recordLatency(op, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    Operation op;
+    chrono::steady_clock::time_point start;
+};
+
+// MetricsReporter Class: Prints a metrics snapshot every interval until destroyed
+class MetricsReporter {
+public:
+    MetricsReporter(ostream& out, chrono::milliseconds interval) : out(out), interval(interval), worker([this] { run(); }) {}
+
+    ~MetricsReporter() {
+        {
+            lock_guard lock(mutex_);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    MetricsReporter(const MetricsReporter&) = delete;
+    MetricsReporter& operator=(const MetricsReporter&) = delete;
+
+private:
+    void run() {
+        unique_lock lock(mutex_);
+        while (!wake.wait_for(lock, interval, [&] { return stopping; })) {
+            Metrics::dump(out);
+        }
+    }
+
+    ostream& out;
+    chrono::milliseconds interval;
+    mutex mutex_;
+    condition_variable wake;  // Signals shutdown
+    bool stopping = false;
+    thread worker;  // Declared last so it starts after every other member is ready
+};
+
+#endif // METRICS_H
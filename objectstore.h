@@ -0,0 +1,171 @@
+#ifndef OBJECTSTORE_H
+#define OBJECTSTORE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <filesystem>
+#include <cstdint>
+#include "metrics.h"
+using namespace std;
+
+// StoredObject: Contents of an object and the version the store gave it
+struct StoredObject {
+    string data;
+    uint64_t version = 0;
+};
+
+// ObjectStore Interface: Minimal remote object store (get, put, list and remove by key)
+// Every successful put gives the object a new, larger version. A put can be made conditional on the
+// version the caller last saw, or on the object not existing yet (kMissing), which is how writers
+// sharing a store avoid overwriting each other. The store counts the bytes it moves.
+class ObjectStore {
+public:
+    static constexpr uint64_t kAnyVersion = UINT64_MAX;  // Unconditional put
+    static constexpr uint64_t kMissing = 0;  // Put only if the object does not exist
+
+    virtual optional<StoredObject> get(const string& key) = 0;  // nullopt if there is no such object
+    // Write an object; returns its new version, or nullopt if ifVersion did not match or the write failed
+    virtual optional<uint64_t> put(const string& key, string_view data, uint64_t ifVersion = kAnyVersion) = 0;
+    virtual vector<string> list(const string& prefix) = 0;  // Keys starting with prefix, in sorted order
+    virtual bool remove(const string& key) = 0;
+    virtual ~ObjectStore() = default;
+
+    uint64_t bytesUploaded() const { return uploaded; }
+    uint64_t bytesDownloaded() const { return downloaded; }
+    uint64_t requestCount() const { return requests; }
+
+protected:
+    void countUpload(size_t bytes) {
+        Metrics::count(Counter::BytesWritten, bytes);
+        uploaded += bytes;
+        requests++;
+    }
+
+    void countDownload(size_t bytes) {
+        Metrics::count(Counter::BytesRead, bytes);
+        downloaded += bytes;
+        requests++;
+    }
+
+private:
+    atomic<uint64_t> uploaded{0};
+    atomic<uint64_t> downloaded{0};
+    atomic<uint64_t> requests{0};
+};
+
+// DirectoryObjectStore Class: Local stand-in for a cloud object store, one file per object
+// An object is stored at <root>/<key> as its version on the first line followed by the data, and
+// is replaced through a temporary file and a rename. Version checks are atomic between users of the
+// same DirectoryObjectStore; separate processes sharing a directory are not coordinated.
+class DirectoryObjectStore : public ObjectStore {
+public:
+    explicit DirectoryObjectStore(string root) : root(std::move(root)) {
+        filesystem::create_directories(this->root);
+    }
+
+    optional<StoredObject> get(const string& key) override {
+        lock_guard lock(mutex_);
+        auto object = read(key);
+        countDownload(object ? object->data.size() : 0);
+        return object;
+    }
+
+    optional<uint64_t> put(const string& key, string_view data, uint64_t ifVersion = kAnyVersion) override {
+        lock_guard lock(mutex_);
+        countUpload(data.size());
+        uint64_t current = currentVersion(key);
+        if (ifVersion != kAnyVersion && ifVersion != current) {
+            return nullopt;  // Someone else changed (or created) the object since the caller looked
+        }
+        filesystem::path path = pathOf(key);
+        filesystem::create_directories(path.parent_path());
+        filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            ofstream file(tempPath, ios::binary | ios::trunc);
+            if (!file.is_open()) {
+                cerr << "Error writing object " << key << endl;
+                return nullopt;
+            }
+            file << current + 1 << "\n";
+            file.write(data.data(), static_cast<streamsize>(data.size()));
+            if (!file.flush()) {
+                return nullopt;
+            }
+        }
+        error_code ec;
+        filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            cerr << "Error replacing object " << key << endl;
+            return nullopt;
+        }
+        return current + 1;
+    }
+
+    vector<string> list(const string& prefix) override {
+        lock_guard lock(mutex_);
+        vector<string> keys;
+        size_t bytes = 0;
+        // Only walk the directory the prefix points into
+        filesystem::path start = pathOf(prefix.substr(0, prefix.rfind('/') + 1));
+        error_code ec;
+        if (filesystem::is_directory(start, ec)) {
+            for (const auto& entry : filesystem::recursive_directory_iterator(start, ec)) {
+                string key = entry.path().lexically_relative(root).generic_string();
+                if (entry.is_regular_file() && key.compare(0, prefix.size(), prefix) == 0
+                    && !key.ends_with(".tmp")) {
+                    bytes += key.size();
+                    keys.push_back(std::move(key));
+                }
+            }
+        }
+        sort(keys.begin(), keys.end());
+        countDownload(bytes);
+        return keys;
+    }
+
+    bool remove(const string& key) override {
+        lock_guard lock(mutex_);
+        countUpload(0);
+        error_code ec;
+        return filesystem::remove(pathOf(key), ec);
+    }
+
+private:
+    filesystem::path pathOf(const string& key) const { return filesystem::path(root) / key; }
+
+    optional<StoredObject> read(const string& key) const {
+        ifstream file(pathOf(key), ios::binary);
+        if (!file.is_open()) {
+            return nullopt;
+        }
+        StoredObject object;
+        if (!(file >> object.version) || file.get() != '\n') {
+            return nullopt;
+        }
+        object.data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        return object;
+    }
+
+    // Version of the stored object, or kMissing; reads only the header line
+    uint64_t currentVersion(const string& key) const {
+        ifstream file(pathOf(key), ios::binary);
+        uint64_t version = kMissing;
+        if (file.is_open() && !(file >> version)) {
+            version = kMissing;
+        }
+        return version;
+    }
+
+    string root;  // Directory holding the objects
+    mutex mutex_;  // Makes each version check and write one step
+};
+
+#endif // OBJECTSTORE_H
@@ -0,0 +1,88 @@
+#ifndef PAYMENT_H
+#define PAYMENT_H
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include "threadpool.h"
+using namespace std;
+
+// Payment Interface: Adheres to the Dependency Inversion Principle (DIP)
+// High-level modules depend on abstractions, not concrete implementations.
+class Payment {
+public:
+    virtual bool processPayment(double amount) = 0;  // Process a payment
+
+    // Start a payment and call done(approved) when it finishes, possibly later and on another thread.
+    // The default runs processPayment inline, so synchronous providers work unchanged.
+    virtual void processPaymentAsync(double amount, function<void(bool)> done) {
+        done(processPayment(amount));
+    }
+
+    // Give back an approved payment that is no longer wanted (for example, its checkout timed out)
+    virtual bool refundPayment(double amount) {
+        cout << "Refunding payment of $" << amount << endl;
+        return true;
+    }
+
+    virtual ~Payment() = default;  // Virtual destructor
+};
+
+// CashPayment Class: Implements the Payment interface for cash payments
+class CashPayment : public Payment {
+public:
+    bool processPayment(double amount) override {
+        cout << "Processing cash payment of $" << amount << endl;
+        return true;
+    }
+};
+
+// OnlinePayment Class: Implements the Payment interface for online payments
+class OnlinePayment : public Payment {
+public:
+    bool processPayment(double amount) override {
+        cout << "Processing online payment of $" << amount << endl;
+        return true;
+    }
+};
+
+// SimulatedOnlinePayment Class: Stand-in for a remote payment provider with a fixed response time
+// Asynchronous payments complete from a timer thread after the latency, so any number can be in
+// flight without holding a thread each. Every declineEvery-th payment is declined (0 = approve all).
+class SimulatedOnlinePayment : public Payment {
+public:
+    explicit SimulatedOnlinePayment(chrono::milliseconds latency, unsigned declineEvery = 0)
+        : latency(latency), declineEvery(declineEvery) {}
+
+    bool processPayment(double amount) override {
+        this_thread::sleep_for(latency);
+        return approveNext();
+    }
+
+    void processPaymentAsync(double amount, function<void(bool)> done) override {
+        bool approved = approveNext();
+        responses.scheduleAfter(latency, [done = std::move(done), approved] { done(approved); });
+    }
+
+    bool refundPayment(double amount) override {
+        refunds++;
+        return true;
+    }
+
+    size_t refundCount() const { return refunds; }
+
+private:
+    bool approveNext() {
+        return declineEvery == 0 || ++payments % declineEvery != 0;
+    }
+
+    chrono::milliseconds latency;  // Time the provider takes to answer
+    unsigned declineEvery;
+    atomic<size_t> payments{0};
+    atomic<size_t> refunds{0};
+    TimerQueue responses;  // Delivers asynchronous answers; declared last so it stops first
+};
+
+#endif // PAYMENT_H
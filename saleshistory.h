@@ -0,0 +1,551 @@
+#ifndef SALESHISTORY_H
+#define SALESHISTORY_H
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <string>
+#include <span>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+using namespace std;
+
+// SalesTotals: Units sold and revenue over some window
+struct SalesTotals {
+    long long units = 0;
+    long long revenueCents = 0;
+};
+
+// One sealed block of sales, compressed. Events are grouped into runs by title, in title order, and
+// each run lists its events in time order:
+//   run:   varint title delta from the previous run, varint (count << 2 | pricesVary << 1 | unitsVary),
+//          varint price in cents
+//   event: varint seconds since the previous event (the first since minTime),
+//          then a zigzag varint price change if pricesVary, then varint units if unitsVary
+// A sale at the title's usual price of one copy therefore costs one or two bytes. Every kSkipEvery-th
+// run is listed in skip, so a query for a few titles jumps straight to them.
+struct SalesBlock {
+    int64_t minTime = 0, maxTime = 0;  // Seconds; every event lies in [minTime, maxTime]
+    uint32_t minTitle = 0, maxTitle = 0;
+    uint32_t events = 0;
+    vector<pair<uint32_t, uint32_t>> skip;  // (title, byte offset) of every kSkipEvery-th run
+    vector<uint8_t> data;
+
+    static constexpr size_t kSkipEvery = 64;
+
+    static constexpr size_t kHeaderBytes = 44;  // Times, titles, counts and checksum in the history file
+
+    // Bytes this block takes in the history file
+    size_t storedBytes() const { return kHeaderBytes + skip.size() * 8 + data.size(); }
+};
+
+// SalesHistory Class: Per-title sales history in compressed time blocks, with windowed queries
+// record appends to an in-memory buffer; once it holds blockEvents sales the buffer is swapped out and,
+// outside the lock, sorted by title and time and sealed into a SalesBlock, which is appended to the
+// history file (with a checksum) if there is one. Queries
+// aggregate units and revenue per time bucket for one title, a set of titles (an author) or the whole
+// store, decoding only the blocks whose time range meets the window and, for title queries, only the
+// runs of those titles. Title ids are the library's inventory slots. Timestamps are Unix seconds.
+// Thread-safe: recording and queries may run on any threads; queries decode sealed blocks without
+// holding up recording.
+class SalesHistory {
+public:
+    // filename empty keeps the history in memory only; otherwise existing blocks are loaded from it
+    // and new ones appended. Sales still in the buffer reach the file on flush() or destruction.
+    explicit SalesHistory(string filename = "", size_t blockEvents = 1 << 20)
+        : filename(std::move(filename)), blockEvents(max<size_t>(blockEvents, 1)) {
+        if (!this->filename.empty()) {
+            load();
+        }
+        buffer.reserve(this->blockEvents);
+    }
+
+    ~SalesHistory() { flush(); }
+
+    SalesHistory(const SalesHistory&) = delete;
+    SalesHistory& operator=(const SalesHistory&) = delete;
+
+    // Record a sale of units copies of title at time (seconds) for priceCents each. The sale that
+    // fills the buffer seals it, but other threads keep recording meanwhile.
+    void record(uint32_t title, int64_t time, int64_t priceCents, uint32_t units = 1) {
+        {
+            lock_guard lock(mutex_);
+            buffer.push_back({title, units, time, priceCents});
+            if (buffer.size() < blockEvents) {
+                return;
+            }
+            swapOutLocked();
+        }
+        sealPending();
+    }
+
+    // Seal buffered sales into a block (and the file), even if the block is not full
+    void flush() {
+        {
+            lock_guard lock(mutex_);
+            swapOutLocked();
+        }
+        sealPending();
+    }
+
+    // Units and revenue per bucketSeconds-long bucket of [from, to), for the given titles (sorted
+    // ascending) or for the whole store if titles is empty. Result i covers [from + i*bucket, ...).
+    vector<SalesTotals> histogram(int64_t from, int64_t to, int64_t bucketSeconds, span<const uint32_t> titles = {}) const {
+        bucketSeconds = max<int64_t>(bucketSeconds, 1);
+        vector<SalesTotals> buckets(to > from ? size_t((to - from + bucketSeconds - 1) / bucketSeconds) : 0);
+        if (buckets.empty()) {
+            return buckets;
+        }
+        auto add = [&](int64_t time, int64_t price, uint32_t units) {
+            if (time >= from && time < to) {
+                SalesTotals& bucket = buckets[size_t((time - from) / bucketSeconds)];
+                bucket.units += units;
+                bucket.revenueCents += price * units;
+            }
+        };
+        vector<shared_ptr<const SalesBlock>> sealed;
+        {
+            lock_guard lock(mutex_);
+            sealed = blocks;
+            auto addEvents = [&](const vector<Event>& events) {
+                for (const auto& event : events) {
+                    if (titles.empty() || binary_search(titles.begin(), titles.end(), event.title)) {
+                        add(event.time, event.priceCents, event.units);
+                    }
+                }
+            };
+            for (const auto& events : unsealed) {
+                addEvents(*events);
+            }
+            addEvents(buffer);
+        }
+        for (const auto& block : sealed) {
+            if (block->maxTime < from || block->minTime >= to) {
+                continue;
+            }
+            if (titles.empty()) {
+                decodeRuns(*block, 0, [&](uint32_t, const uint8_t*& p, uint32_t header, int64_t price) {
+                    decodeEvents(*block, p, header, price, add);
+                    return true;
+                });
+                continue;
+            }
+            // Walk the runs of the wanted titles; when the next wanted title lies past a later skip
+            // entry, jump to that entry instead of decoding the runs in between
+            auto skipBefore = [&](uint32_t title) {
+                auto entry = upper_bound(block->skip.begin(), block->skip.end(), title,
+                                         [](uint32_t t, const pair<uint32_t, uint32_t>& e) { return t < e.first; });
+                return entry == block->skip.begin() ? size_t(0) : size_t(entry - block->skip.begin() - 1);
+            };
+            auto it = lower_bound(titles.begin(), titles.end(), block->minTitle);
+            while (it != titles.end() && *it <= block->maxTitle) {
+                decodeRuns(*block, skipBefore(*it), [&](uint32_t title, const uint8_t*& p, uint32_t header, int64_t price) {
+                    while (it != titles.end() && *it < title) {
+                        it++;  // Wanted title with no sales in this block
+                    }
+                    if (it != titles.end() && *it == title) {
+                        decodeEvents(*block, p, header, price, add);
+                        it++;
+                    } else {
+                        skipEvents(p, header);
+                    }
+                    if (it == titles.end() || *it > block->maxTitle) {
+                        it = titles.end();
+                        return false;
+                    }
+                    return block->skip[skipBefore(*it)].second <= size_t(p - block->data.data());
+                });
+            }
+        }
+        return buckets;
+    }
+
+    // Totals over [from, to) for the given titles (sorted), or the whole store if titles is empty
+    SalesTotals totals(int64_t from, int64_t to, span<const uint32_t> titles = {}) const {
+        vector<SalesTotals> all = histogram(from, to, max<int64_t>(to - from, 1), titles);
+        return all.empty() ? SalesTotals{} : all[0];
+    }
+
+    // Sales recorded so far
+    size_t eventCount() const {
+        lock_guard lock(mutex_);
+        size_t total = buffer.size();
+        for (const auto& events : unsealed) {
+            total += events->size();
+        }
+        for (const auto& block : blocks) {
+            total += block->events;
+        }
+        return total;
+    }
+
+    // Bytes taken by sealed blocks (what the history file holds)
+    size_t storedBytes() const {
+        lock_guard lock(mutex_);
+        size_t total = 0;
+        for (const auto& block : blocks) {
+            total += block->storedBytes();
+        }
+        return total;
+    }
+
+private:
+    struct Event {
+        uint32_t title;
+        uint32_t units;
+        int64_t time;
+        int64_t priceCents;
+    };
+
+    static void putVarint(vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    static uint64_t getVarint(const uint8_t*& p) {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+    }
+
+    static uint64_t zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+    static int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+    // Walk the runs of block from skip entry start; f(title, p, header, price) must consume the run's
+    // events from p and returns false to stop
+    template <typename F>
+    static void decodeRuns(const SalesBlock& block, size_t start, F&& f) {
+        const uint8_t* p = block.data.data();
+        const uint8_t* end = p + block.data.size();
+        uint32_t title = 0;
+        if (start < block.skip.size()) {
+            p += block.skip[start].second;
+            title = block.skip[start].first;
+            getVarint(p);  // Delta from the run before, already folded into the skip entry
+        } else if (p < end) {
+            title = uint32_t(getVarint(p));
+        }
+        while (p < end) {
+            uint32_t header = uint32_t(getVarint(p));
+            int64_t price = int64_t(getVarint(p));
+            if (!f(title, p, header, price)) {
+                return;
+            }
+            if (p < end) {
+                title += uint32_t(getVarint(p));
+            }
+        }
+    }
+
+    template <typename Add>
+    static void decodeEvents(const SalesBlock& block, const uint8_t*& p, uint32_t header, int64_t price, Add&& add) {
+        int64_t time = block.minTime;
+        for (uint32_t i = header >> 2; i > 0; i--) {
+            time += int64_t(getVarint(p));
+            if ((header & 2) && i != header >> 2) {
+                price += unzigzag(getVarint(p));
+            }
+            uint32_t units = (header & 1) ? uint32_t(getVarint(p)) : 1;
+            add(time, price, units);
+        }
+    }
+
+    static void skipEvents(const uint8_t*& p, uint32_t header) {
+        size_t varints = (header >> 2) * (1 + ((header & 1) ? 1 : 0) + ((header & 2) ? 1 : 0)) - ((header & 2) ? 1 : 0);
+        for (size_t i = 0; i < varints; i++) {
+            while (*p++ >= 0x80) {
+            }
+        }
+    }
+
+    // Hand the buffer to the sealers and start a new one; caller holds mutex_
+    void swapOutLocked() {
+        if (buffer.empty()) {
+            return;
+        }
+        unsealed.push_back(make_shared<const vector<Event>>(std::move(buffer)));
+        buffer = vector<Event>();
+        buffer.reserve(blockEvents);
+    }
+
+    // Seal the swapped-out buffers, oldest first, without holding mutex_ while they are encoded and
+    // written. Returns once every buffer swapped out before the call is sealed.
+    void sealPending() {
+        lock_guard sealLock(sealMutex);
+        while (true) {
+            shared_ptr<const vector<Event>> events;
+            {
+                lock_guard lock(mutex_);
+                if (unsealed.empty()) {
+                    return;
+                }
+                events = unsealed.front();
+            }
+            shared_ptr<const SalesBlock> block = encode(*events);
+            if (!filename.empty()) {
+                append(*block);
+            }
+            lock_guard lock(mutex_);
+            unsealed.erase(unsealed.begin());
+            blocks.push_back(std::move(block));
+        }
+    }
+
+    // Sort sales by title and time and encode them as a block. Queries may be reading the swapped-out
+    // buffer, so it is sorted as a copy.
+    static shared_ptr<SalesBlock> encode(const vector<Event>& events) {
+        vector<Event> buffer = events;
+        sort(buffer.begin(), buffer.end(), [](const Event& a, const Event& b) {
+            return a.title != b.title ? a.title < b.title : a.time < b.time;
+        });
+        auto block = make_shared<SalesBlock>();
+        block->events = uint32_t(buffer.size());
+        block->minTitle = buffer.front().title;
+        block->maxTitle = buffer.back().title;
+        block->minTime = block->maxTime = buffer.front().time;
+        for (const auto& event : buffer) {
+            block->minTime = min(block->minTime, event.time);
+            block->maxTime = max(block->maxTime, event.time);
+        }
+        vector<uint8_t>& out = block->data;
+        out.reserve(buffer.size() * 2);
+        uint32_t previousTitle = 0;
+        size_t runs = 0;
+        for (size_t first = 0; first < buffer.size();) {
+            size_t last = first;
+            bool pricesVary = false, unitsVary = false;
+            while (last < buffer.size() && buffer[last].title == buffer[first].title) {
+                pricesVary |= buffer[last].priceCents != buffer[first].priceCents;
+                unitsVary |= buffer[last].units != 1;
+                last++;
+            }
+            if (runs++ % SalesBlock::kSkipEvery == 0) {
+                block->skip.emplace_back(buffer[first].title, uint32_t(out.size()));
+            }
+            putVarint(out, buffer[first].title - previousTitle);
+            putVarint(out, uint64_t(last - first) << 2 | uint64_t(pricesVary) << 1 | uint64_t(unitsVary));
+            putVarint(out, uint64_t(buffer[first].priceCents));
+            int64_t time = block->minTime, price = buffer[first].priceCents;
+            for (size_t i = first; i < last; i++) {
+                putVarint(out, uint64_t(buffer[i].time - time));
+                time = buffer[i].time;
+                if (pricesVary && i != first) {
+                    putVarint(out, zigzag(buffer[i].priceCents - price));
+                    price = buffer[i].priceCents;
+                }
+                if (unitsVary) {
+                    putVarint(out, buffer[i].units);
+                }
+            }
+            previousTitle = buffer[first].title;
+            first = last;
+        }
+        return block;
+    }
+
+    // Block header as stored, checksum aside: times, titles, event count, skip count, data bytes
+    static array<char, 36> headerBytes(const SalesBlock& block) {
+        array<char, 36> header;
+        uint32_t skipCount = uint32_t(block.skip.size()), dataBytes = uint32_t(block.data.size());
+        memcpy(header.data(), &block.minTime, 8);
+        memcpy(header.data() + 8, &block.maxTime, 8);
+        memcpy(header.data() + 16, &block.minTitle, 4);
+        memcpy(header.data() + 20, &block.maxTitle, 4);
+        memcpy(header.data() + 24, &block.events, 4);
+        memcpy(header.data() + 28, &skipCount, 4);
+        memcpy(header.data() + 32, &dataBytes, 4);
+        return header;
+    }
+
+    // FNV-1a style mixing over 64-bit words (byte-wise for each tail) of the header, the skip list
+    // and the data, like the binary snapshot checksum
+    static uint64_t checksum(const SalesBlock& block) {
+        const uint64_t prime = 1099511628211ull;
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&](const void* bytes, size_t size) {
+            const char* data = static_cast<const char*>(bytes);
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                uint64_t word;
+                memcpy(&word, data + i, 8);
+                hash = (hash ^ word) * prime;
+            }
+            for (; i < size; i++) {
+                hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+            }
+        };
+        array<char, 36> header = headerBytes(block);
+        mix(header.data(), header.size());
+        mix(block.skip.data(), block.skip.size() * 8);
+        mix(block.data.data(), block.data.size());
+        return hash;
+    }
+
+    // Append a sealed block to the history file
+    void append(const SalesBlock& block) {
+        ofstream out(filename, ios::binary | ios::app);
+        if (!out) {
+            cerr << "Error opening sales history " << filename << endl;
+            return;
+        }
+        array<char, 36> header = headerBytes(block);
+        uint64_t sum = checksum(block);
+        out.write(header.data(), header.size());
+        out.write(reinterpret_cast<const char*>(&sum), 8);
+        out.write(reinterpret_cast<const char*>(block.skip.data()), streamsize(block.skip.size() * 8));
+        out.write(reinterpret_cast<const char*>(block.data.data()), streamsize(block.data.size()));
+    }
+
+    // Read every complete block from the history file. A torn block (a crash while appending) is cut
+    // off the file, so blocks appended from now on follow the last good one. A complete block that
+    // fails its checks is cut off with everything after it too, but the file is first copied to
+    // <filename>.bad so nothing is lost for good.
+    void load() {
+        ifstream in(filename, ios::binary);
+        if (!in) {
+            return;  // No history yet
+        }
+        error_code error;
+        uint64_t fileSize = filesystem::file_size(filename, error);
+        if (error) {
+            cerr << "Error reading sales history " << filename << endl;
+            return;
+        }
+        uint64_t good = 0;  // End of the last complete block
+        bool corrupt = false;  // Stopped at a block that was all there but failed its checks
+        while (fileSize - good >= SalesBlock::kHeaderBytes) {
+            auto block = make_shared<SalesBlock>();
+            uint32_t skipCount = 0, dataBytes = 0;
+            uint64_t sum = 0;
+            in.read(reinterpret_cast<char*>(&block->minTime), 8);
+            in.read(reinterpret_cast<char*>(&block->maxTime), 8);
+            in.read(reinterpret_cast<char*>(&block->minTitle), 4);
+            in.read(reinterpret_cast<char*>(&block->maxTitle), 4);
+            in.read(reinterpret_cast<char*>(&block->events), 4);
+            in.read(reinterpret_cast<char*>(&skipCount), 4);
+            in.read(reinterpret_cast<char*>(&dataBytes), 4);
+            in.read(reinterpret_cast<char*>(&sum), 8);
+            uint64_t bodyBytes = uint64_t(skipCount) * 8 + dataBytes;
+            if (!in || bodyBytes > fileSize - good - SalesBlock::kHeaderBytes) {
+                break;
+            }
+            block->skip.resize(skipCount);
+            block->data.resize(dataBytes);
+            in.read(reinterpret_cast<char*>(block->skip.data()), streamsize(skipCount * 8));
+            in.read(reinterpret_cast<char*>(block->data.data()), dataBytes);
+            if (!in || checksum(*block) != sum || !blockValid(*block)) {
+                corrupt = bool(in);
+                break;
+            }
+            good += SalesBlock::kHeaderBytes + bodyBytes;
+            blocks.push_back(std::move(block));
+        }
+        in.close();
+        if (corrupt) {
+            filesystem::copy_file(filename, filename + ".bad", filesystem::copy_options::overwrite_existing, error);
+            cerr << "Sales history " << filename << ": corrupt block, saved a copy as " << filename << ".bad" << endl;
+        }
+        if (good < fileSize) {
+            cerr << "Sales history " << filename << ": dropping " << fileSize - good << " bytes after the last good block" << endl;
+            filesystem::resize_file(filename, good, error);
+        }
+    }
+
+    // Read a varint that must end before end and fit in 64 bits
+    static bool checkedVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Decode a loaded block once with every read bounds-checked, so the unchecked decoders used by
+    // queries can trust it: runs stay inside the data with titles in [minTitle, maxTitle], skip
+    // entries sit on run starts, times stay in [minTime, maxTime], prices are small enough that price
+    // times units cannot overflow, and the events add up to the count.
+    static bool blockValid(const SalesBlock& block) {
+        const int64_t kMaxPrice = INT32_MAX;
+        if (block.minTime > block.maxTime) {
+            return false;
+        }
+        const uint8_t* begin = block.data.data();
+        const uint8_t* p = begin;
+        const uint8_t* end = begin + block.data.size();
+        uint64_t title = 0, events = 0;
+        size_t runs = 0, nextSkip = 0;
+        while (p < end) {
+            size_t offset = size_t(p - begin);
+            uint64_t delta = 0, header = 0, price = 0;
+            if (!checkedVarint(p, end, delta) || delta > UINT32_MAX) {
+                return false;
+            }
+            title += delta;
+            if (title < block.minTitle || title > block.maxTitle) {
+                return false;
+            }
+            if (runs++ % SalesBlock::kSkipEvery == 0) {
+                if (nextSkip >= block.skip.size() || block.skip[nextSkip] != pair<uint32_t, uint32_t>(uint32_t(title), uint32_t(offset))) {
+                    return false;
+                }
+                nextSkip++;
+            }
+            if (!checkedVarint(p, end, header) || !checkedVarint(p, end, price) || header > UINT32_MAX || header >> 2 == 0) {
+                return false;
+            }
+            events += header >> 2;
+            if (events > block.events || price > uint64_t(kMaxPrice)) {
+                return false;
+            }
+            int64_t time = block.minTime, eventPrice = int64_t(price);
+            for (uint64_t i = 0; i < header >> 2; i++) {
+                uint64_t value = 0;
+                if (!checkedVarint(p, end, value) || value > uint64_t(block.maxTime) - uint64_t(time)) {
+                    return false;
+                }
+                time = int64_t(uint64_t(time) + value);
+                if ((header & 2) && i > 0) {
+                    if (!checkedVarint(p, end, value) || value >= uint64_t(4) * kMaxPrice) {
+                        return false;
+                    }
+                    eventPrice += unzigzag(value);
+                    if (eventPrice < -kMaxPrice || eventPrice > kMaxPrice) {
+                        return false;
+                    }
+                }
+                if ((header & 1) && (!checkedVarint(p, end, value) || value > UINT32_MAX)) {
+                    return false;
+                }
+            }
+        }
+        return events == block.events && nextSkip == block.skip.size();
+    }
+
+    string filename;  // History file, or empty
+    size_t blockEvents;  // Sales per sealed block
+    mutable mutex mutex_;  // Guards buffer, unsealed and blocks
+    mutex sealMutex;  // Serializes sealing and appending to the file; taken before mutex_
+    vector<Event> buffer;  // Sales not yet sealed
+    vector<shared_ptr<const vector<Event>>> unsealed;  // Full buffers being sealed, oldest first
+    vector<shared_ptr<const SalesBlock>> blocks;  // Sealed blocks, oldest first
+};
+
+#endif // SALESHISTORY_H
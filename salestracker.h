@@ -0,0 +1,207 @@
+#ifndef SALESTRACKER_H
+#define SALESTRACKER_H
+
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+using namespace std;
+
+// SalesTracker Class: Units sold per title, a live bestseller ranking and a reorder list
+// Kept up to date one change at a time, so neither query has to scan or sort the catalog:
+// - An indexed max-heap orders every title by units sold. A sale moves its title up or down the heap
+//   in O(log n), and the top n are read off the heap in O(n log n) without touching the rest.
+// - Titles with fewer copies than the reorder threshold sit in one bucket per quantity. A stock
+//   change moves a title between buckets in O(1), and the titles below any threshold up to the
+//   reorder threshold are the contents of the buckets under it.
+// Slots are numbered as books are added, matching the library's inventory slots. Not thread-safe,
+// except that notePending may run on many threads at once (see below).
+class SalesTracker {
+public:
+    explicit SalesTracker(int reorderThreshold) : threshold(max(reorderThreshold, 0)), buckets(threshold) {}
+
+    // Titles on the reorder list
+    size_t lowCount() const {
+        size_t count = 0;
+        for (const auto& bucket : buckets) {
+            count += bucket.size();
+        }
+        return count;
+    }
+
+    int reorderThreshold() const { return threshold; }
+
+    // Start tracking the book at the next slot
+    void addBook(int quantity) {
+        uint32_t slot = static_cast<uint32_t>(heapPos.size());
+        heapPos.push_back(static_cast<uint32_t>(heap.size()));
+        heap.push_back({0, slot});
+        siftUp(heapPos[slot]);
+        bucketOf.push_back(kNotLow);
+        bucketPos.push_back(0);
+        pending.emplace_back();
+        stockChanged(slot, quantity);
+    }
+
+    // Sales can be noted from any number of threads at once without the tracker's lock: each adds
+    // to its slot's pending count, and the first since the last catchUp returns true, telling the
+    // caller to listPending(slot) under the lock. catchUp moves the pending counts into the ranking.
+    bool notePending(size_t slot, long long copies) {
+        // Sequentially consistent throughout, so catchUp either sees this count or is seen unlisting
+        atomic_ref<long long>(pending[slot].copies).fetch_add(copies);
+        atomic_ref<uint8_t> listed(pending[slot].listed);
+        return listed.load() == 0 && listed.exchange(1) == 0;
+    }
+
+    void listPending(size_t slot) { pendingSlots.push_back(static_cast<uint32_t>(slot)); }
+
+    void catchUp() {
+        for (uint32_t slot : pendingSlots) {
+            // Unlist before taking the count: a sale noted in between lists the slot again
+            atomic_ref<uint8_t>(pending[slot].listed).store(0);
+            long long copies = atomic_ref<long long>(pending[slot].copies).exchange(0);
+            if (copies != 0) {
+                recordSale(slot, copies);
+            }
+        }
+        pendingSlots.clear();
+    }
+
+    // Count copies sold of the book at slot (negative for copies returned)
+    void recordSale(size_t slot, long long copies) {
+        heap[heapPos[slot]].sold += copies;
+        if (copies > 0) {
+            siftUp(heapPos[slot]);
+        } else {
+            siftDown(heapPos[slot]);
+        }
+    }
+
+    // Note the new quantity of the book at slot
+    void stockChanged(size_t slot, int quantity) {
+        uint32_t bucket = quantity < threshold ? static_cast<uint32_t>(max(quantity, 0)) : kNotLow;
+        if (bucket == bucketOf[slot]) {
+            return;
+        }
+        if (bucketOf[slot] != kNotLow) {
+            // Swap-remove from the old bucket
+            vector<uint32_t>& old = buckets[bucketOf[slot]];
+            uint32_t moved = old.back();
+            old[bucketPos[slot]] = moved;
+            bucketPos[moved] = bucketPos[slot];
+            old.pop_back();
+        }
+        bucketOf[slot] = bucket;
+        if (bucket != kNotLow) {
+            bucketPos[slot] = static_cast<uint32_t>(buckets[bucket].size());
+            buckets[bucket].push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    long long unitsSold(size_t slot) const { return heap[heapPos[slot]].sold; }
+
+    // Up to n (slot, units sold) pairs for the best-selling titles, best first; titles that have not
+    // sold are left out. Ties go to the lower slot.
+    vector<pair<size_t, long long>> topSellers(size_t n) const {
+        vector<pair<size_t, long long>> result;
+        // Best-first walk of the heap: the next best title is always a child of one already taken
+        auto worse = [&](uint32_t a, uint32_t b) { return ranksAbove(heap[b], heap[a]); };
+        priority_queue<uint32_t, vector<uint32_t>, decltype(worse)> frontier(worse);
+        if (!heap.empty()) {
+            frontier.push(0);
+        }
+        while (!frontier.empty() && result.size() < n) {
+            uint32_t position = frontier.top();
+            frontier.pop();
+            if (heap[position].sold <= 0) {
+                break;
+            }
+            result.emplace_back(heap[position].slot, heap[position].sold);
+            for (uint32_t child = 2 * position + 1; child <= 2 * position + 2 && child < heap.size(); child++) {
+                frontier.push(child);
+            }
+        }
+        return result;
+    }
+
+    // Slots of books with fewer than below copies, in slot order. below must not exceed the reorder threshold.
+    vector<size_t> belowThreshold(int below) const {
+        vector<size_t> slots;
+        for (int quantity = 0; quantity < min(below, threshold); quantity++) {
+            slots.insert(slots.end(), buckets[quantity].begin(), buckets[quantity].end());
+        }
+        sort(slots.begin(), slots.end());
+        return slots;
+    }
+
+private:
+    static constexpr uint32_t kNotLow = UINT32_MAX;  // bucketOf value for books at or above the threshold
+
+    // Heap entries carry their units sold, so a sift compares entries without a lookup per level
+    struct Entry {
+        long long sold;
+        uint32_t slot;
+    };
+
+    // Copies noted for a slot since the last catchUp, and whether it is in pendingSlots; side by side
+    // so a sale touches one cache line
+    struct Pending {
+        long long copies = 0;
+        uint8_t listed = 0;
+    };
+
+    // Whether entry a ranks above entry b
+    static bool ranksAbove(const Entry& a, const Entry& b) {
+        return a.sold != b.sold ? a.sold > b.sold : a.slot < b.slot;
+    }
+
+    void place(uint32_t position, const Entry& entry) {
+        heap[position] = entry;
+        heapPos[entry.slot] = position;
+    }
+
+    void siftUp(uint32_t position) {
+        Entry entry = heap[position];
+        while (position > 0) {
+            uint32_t parent = (position - 1) / 2;
+            if (!ranksAbove(entry, heap[parent])) {
+                break;
+            }
+            place(position, heap[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void siftDown(uint32_t position) {
+        Entry entry = heap[position];
+        while (true) {
+            uint32_t child = 2 * position + 1;
+            if (child >= heap.size()) {
+                break;
+            }
+            if (child + 1 < heap.size() && ranksAbove(heap[child + 1], heap[child])) {
+                child++;
+            }
+            if (!ranksAbove(heap[child], entry)) {
+                break;
+            }
+            place(position, heap[child]);
+            position = child;
+        }
+        place(position, entry);
+    }
+
+    int threshold;  // Reorder threshold: books with fewer copies are on the reorder list
+    vector<Entry> heap;  // Max-heap of slots by units sold
+    vector<uint32_t> heapPos;  // Position of each slot in heap
+    vector<vector<uint32_t>> buckets;  // buckets[q]: slots with q copies (0 also holds negative stock)
+    vector<uint32_t> bucketOf;  // Bucket of each slot, or kNotLow
+    vector<uint32_t> bucketPos;  // Position of each slot in its bucket
+    vector<Pending> pending;  // Sales noted but not yet ranked, per slot (changed through atomic_ref)
+    vector<uint32_t> pendingSlots;  // Slots with pending sales, in the order they were listed
+};
+
+#endif // SALESTRACKER_H
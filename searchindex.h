@@ -0,0 +1,184 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <cctype>
+#include <cstdint>
+#include "book.h"
+#include "sortedrunindex.h"
+using namespace std;
+
+// SearchIndex Class: Title autocomplete and keyword/author search over inventory slots
+// - titlePrefixes: lower-cased titles in a SortedRunIndex, so "titles starting with 'the s'" is a
+//   binary search plus a walk over the matching range.
+// - tokens: inverted index from each lower-cased title or author word to the slots containing it.
+// - authors: lower-cased full author name to its slots, plus authorOrder, a SortedRunIndex over the
+//   distinct names, so "authors from a to c, in order" walks the names in range and their slot lists.
+// Posting lists are kept in slot order because slots are always added in increasing order, which
+// lets keyword queries intersect them with a linear merge. The owner (Library) serializes updates.
+class SearchIndex {
+public:
+    // Index one book stored at slot
+    void add(uint32_t slot, const Book& book) {
+        string title = normalize(book.getTitle());
+        indexWords(slot, title, book.getAuthor());
+        titlePrefixes.insert(std::move(title), slot);
+    }
+
+    // Index books stored at consecutive slots starting at firstSlot, merging the prefix index once
+    void addRange(uint32_t firstSlot, span<const Book> books) {
+        vector<SortedRunIndex<string>::Entry> titles;
+        titles.reserve(books.size());
+        for (size_t i = 0; i < books.size(); i++) {
+            uint32_t slot = firstSlot + static_cast<uint32_t>(i);
+            string title = normalize(books[i].getTitle());
+            indexWords(slot, title, books[i].getAuthor());
+            titles.emplace_back(std::move(title), slot);
+        }
+        titlePrefixes.insertBulk(std::move(titles));
+    }
+
+    // Slots of books whose title starts with prefix (case-insensitive), in title order
+    vector<size_t> titlesWithPrefix(string_view prefix, size_t limit) const {
+        vector<size_t> slots;
+        string from = normalize(prefix);
+        titlePrefixes.scan(from,
+            [&](const string& title) { return title.compare(0, from.size(), from) == 0; },
+            [&](const SortedRunIndex<string>::Entry& entry) {
+                slots.push_back(entry.second);
+                return slots.size() < limit;
+            });
+        return slots;
+    }
+
+    // Slots of books by an author (case-insensitive exact name), in inventory order
+    vector<size_t> booksByAuthor(string_view author) const {
+        auto it = authors.find(normalize(author));
+        if (it == authors.end()) {
+            return {};
+        }
+        const vector<uint32_t>& slots = authorSlots[it->second];
+        return vector<size_t>(slots.begin(), slots.end());
+    }
+
+    // Visit the slots of books whose author (case-insensitive) lies in the range from..to as
+    // visit(slot) until it returns false: authors in name order, each author's books in slot order.
+    // A name is in range if it is >= from and its first to.size() characters are <= to, so "a".."c"
+    // covers every author whose name starts with a, b or c.
+    template <typename Visit>
+    void forEachAuthorInRange(string_view from, string_view to, Visit visit) const {
+        string last = normalize(to);
+        bool more = true;
+        authorOrder.scan(normalize(from),
+            [&](const string& name) { return name.compare(0, last.size(), last) <= 0; },
+            [&](const SortedRunIndex<string>::Entry& entry) {
+                for (uint32_t slot : authorSlots[entry.second]) {
+                    if (!visit(slot)) {
+                        more = false;
+                        break;
+                    }
+                }
+                return more;
+            });
+    }
+
+    // Slots of books whose title or author contains every word of the query, in inventory order
+    vector<size_t> keywordSearch(string_view query, size_t limit) const {
+        vector<const vector<uint32_t>*> lists;
+        forEachWord(normalize(query), [&](string_view word) {
+            auto it = tokens.find(word);
+            lists.push_back(it == tokens.end() ? nullptr : &it->second);
+        });
+        vector<size_t> slots;
+        if (lists.empty() || find(lists.begin(), lists.end(), nullptr) != lists.end()) {
+            return slots;
+        }
+        // Walk the shortest list and check the others with a moving cursor each
+        sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+        vector<size_t> cursor(lists.size(), 0);
+        for (uint32_t slot : *lists[0]) {
+            bool everywhere = true;
+            for (size_t i = 1; i < lists.size() && everywhere; i++) {
+                const auto& list = *lists[i];
+                cursor[i] = lower_bound(list.begin() + cursor[i], list.end(), slot) - list.begin();
+                everywhere = cursor[i] < list.size() && list[cursor[i]] == slot;
+            }
+            if (everywhere) {
+                slots.push_back(slot);
+                if (slots.size() >= limit) {
+                    break;
+                }
+            }
+        }
+        return slots;
+    }
+
+    // Lower-case ASCII letters; everything else is kept as is
+    static string normalize(string_view text) {
+        string out(text);
+        for (char& c : out) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return out;
+    }
+
+private:
+    // Call f for every run of letters/digits in already normalized text
+    template <typename F>
+    static void forEachWord(string_view text, F f) {
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !isalnum(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+            size_t start = i;
+            while (i < text.size() && isalnum(static_cast<unsigned char>(text[i]))) {
+                i++;
+            }
+            if (i > start) {
+                f(text.substr(start, i - start));
+            }
+        }
+    }
+
+    void indexWords(uint32_t slot, const string& normalizedTitle, const string& author) {
+        string normalizedAuthor = normalize(author);
+        auto addToken = [&](string_view word) {
+            auto it = tokens.find(word);
+            if (it == tokens.end()) {
+                it = tokens.emplace(string(word), vector<uint32_t>()).first;
+            }
+            if (it->second.empty() || it->second.back() != slot) {  // A word repeated in one book counts once
+                it->second.push_back(slot);
+            }
+        };
+        forEachWord(normalizedTitle, addToken);
+        forEachWord(normalizedAuthor, addToken);
+        auto it = authors.find(normalizedAuthor);
+        if (it == authors.end()) {
+            uint32_t id = static_cast<uint32_t>(authorSlots.size());
+            authorSlots.emplace_back();
+            authorOrder.insert(normalizedAuthor, id);
+            it = authors.emplace(std::move(normalizedAuthor), id).first;
+        }
+        authorSlots[it->second].push_back(slot);
+    }
+
+    // Transparent hash so string_view probes don't allocate
+    struct WordHash {
+        using is_transparent = void;
+        size_t operator()(string_view word) const { return hash<string_view>{}(word); }
+    };
+
+    SortedRunIndex<string> titlePrefixes;  // Lower-cased title -> slot, ordered
+    unordered_map<string, vector<uint32_t>, WordHash, equal_to<>> tokens;  // Word -> slots
+    unordered_map<string, uint32_t, WordHash, equal_to<>> authors;  // Author -> index into authorSlots
+    vector<vector<uint32_t>> authorSlots;  // Slots of each author's books
+    SortedRunIndex<string> authorOrder;  // Distinct authors -> index into authorSlots, ordered
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,433 @@
+#ifndef SHAREDINVENTORY_H
+#define SHAREDINVENTORY_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "inventoryy.h"
+#include "book.h"
+#include "filestorage.h"
+#include "inventoryexport.h"
+using namespace std;
+
+// SharedInventory Class: Inventory kept in a POSIX shared-memory segment, used by several processes at once
+// Implements the InventoryManager interface like Library, so terminals on one host can sell from the
+// same stock instead of each loading a private copy of inventory.txt and overwriting the others' sales.
+// - The segment holds fixed-size book records, their titles and authors in a string arena, and an
+//   open-addressing title index. A process attaching to an existing segment maps it and is ready at
+//   once: nothing is parsed and no index is rebuilt.
+// - Quantities are lock-free atomics in the shared records, so sales in different processes never
+//   lose an update and never oversell. Adding a book takes a process-shared robust mutex; a book is
+//   published to other processes only once its record and strings are complete.
+// - One process at a time owns persistence (claimPersistence). The owner writes the whole inventory
+//   to storage when it has changed since the last save, whichever process made the changes.
+// The segment outlives the processes using it until remove() is called.
+class SharedInventory : public InventoryManager {
+public:
+    // Segment the --shared terminals (main_compact) keep inventory.txt in
+    static constexpr const char* kTerminalSegment = "/library-inventory";
+
+    // Create a segment with room for capacity books and arenaBytes of title and author text, and fill
+    // it with books before any other process can attach. Returns nullptr if the name is taken or on error.
+    static unique_ptr<SharedInventory> create(const string& name, size_t capacity, size_t arenaBytes,
+                                              const vector<Book>& books = {}) {
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            if (errno != EEXIST) {
+                cerr << "Cannot create shared inventory " << name << ": " << strerror(errno) << endl;
+            }
+            return nullptr;
+        }
+        size_t bucketCount = 16;
+        while (bucketCount < 2 * capacity) {
+            bucketCount *= 2;
+        }
+        Layout layout(capacity, bucketCount, arenaBytes);
+        void* base = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(layout.total)) == 0) {
+            base = mmap(nullptr, layout.total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (base == MAP_FAILED) {
+            cerr << "Cannot size shared inventory " << name << ": " << strerror(errno) << endl;
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+        auto* header = new (base) Header;
+        header->capacity = capacity;
+        header->bucketCount = bucketCount;
+        header->arenaBytes = arenaBytes;
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->appendMutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+
+        unique_ptr<SharedInventory> inventory(new SharedInventory(base, layout.total));
+        for (const auto& book : books) {
+            if (!inventory->append(book)) {
+                break;
+            }
+        }
+        header->magic.store(kMagic, memory_order_release);  // Attaching processes wait for this
+        return inventory;
+    }
+
+    // Map an existing segment, waiting briefly for its creator to finish filling it.
+    // Returns nullptr if there is no such segment or it never became ready.
+    static unique_ptr<SharedInventory> attach(const string& name, chrono::milliseconds wait = chrono::seconds(10)) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            return nullptr;
+        }
+        auto deadline = chrono::steady_clock::now() + wait;
+        struct stat info;
+        while (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) < sizeof(Header)) {
+            if (chrono::steady_clock::now() > deadline) {
+                close(fd);
+                cerr << "Shared inventory " << name << " was never sized" << endl;
+                return nullptr;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        size_t length = static_cast<size_t>(info.st_size);
+        void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            cerr << "Cannot map shared inventory " << name << ": " << strerror(errno) << endl;
+            return nullptr;
+        }
+        // The creator fills in the sizes after ftruncate, so read them only once magic is published
+        const Header* header = static_cast<const Header*>(base);
+        while (header->magic.load(memory_order_acquire) != kMagic) {
+            if (chrono::steady_clock::now() > deadline) {
+                cerr << "Shared inventory " << name << " never became ready" << endl;
+                munmap(base, length);
+                return nullptr;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        if (length < Layout(header->capacity, header->bucketCount, header->arenaBytes).total) {
+            cerr << "Shared inventory " << name << " is smaller than its header says" << endl;
+            munmap(base, length);
+            return nullptr;
+        }
+        return unique_ptr<SharedInventory>(new SharedInventory(base, length));
+    }
+
+    // Attach to the segment if it exists; otherwise load filename through storage and create it with
+    // room for the loaded books to double. When several processes start together, one creates and
+    // the others attach.
+    static unique_ptr<SharedInventory> openOrLoad(const string& name, FileStorageBase& storage, const string& filename) {
+        if (auto inventory = attach(name)) {
+            return inventory;
+        }
+        vector<Book> books = storage.loadFromFile(filename);
+        size_t textBytes = 0;
+        for (const auto& book : books) {
+            textBytes += book.getTitle().size() + book.getAuthor().size();
+        }
+        if (auto inventory = create(name, max<size_t>(2 * books.size(), 1024), 2 * textBytes + (1 << 20), books)) {
+            return inventory;
+        }
+        return attach(name);  // Another process created it first
+    }
+
+    // Whether a segment called name exists (it stays until remove(), even with no process attached)
+    static bool exists(const string& name) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        close(fd);
+        return true;
+    }
+
+    // For programs that write inventory.txt on their own. The --shared terminals' segment holds stock
+    // that a later --shared terminal would save over their changes, so they must not start while it
+    // exists. Reports it on cerr and returns true if it does.
+    static bool terminalSegmentBlocks() {
+        if (!exists(kTerminalSegment)) {
+            return false;
+        }
+        cerr << "Shared inventory " << kTerminalSegment << " still holds the --shared terminals' stock; finish "
+             << "a --shared terminal to save and remove it (or delete /dev/shm" << kTerminalSegment
+             << " to discard it) first" << endl;
+        return true;
+    }
+
+    // Delete the segment name; processes still attached keep their mapping until they exit
+    static void remove(const string& name) {
+        shm_unlink(name.c_str());
+    }
+
+    ~SharedInventory() override {
+        int me = getpid();
+        header->persistenceOwner.compare_exchange_strong(me, 0);
+        munmap(base, length);
+    }
+
+    SharedInventory(const SharedInventory&) = delete;
+    SharedInventory& operator=(const SharedInventory&) = delete;
+
+    // Add a book to the shared inventory (reports an error if the segment is full)
+    void addBook(const Book& book) override {
+        if (!append(book)) {
+            cerr << "Shared inventory is full; cannot add " << book.getTitle() << endl;
+        }
+    }
+
+    // Display the shared inventory
+    void displayInventory() const override {
+        exportInventory(cout, {});
+    }
+
+    // Add quantity copies (negative to remove) to a book by title
+    bool updateStock(const string& title, int quantity) override {
+        auto slot = findBook(title);
+        if (!slot) {
+            return false;
+        }
+        stock(*slot).fetch_add(quantity, memory_order_relaxed);
+        header->changes.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    // Sell one copy of a book by title
+    bool sellBook(string_view title) {
+        auto slot = findBook(title);
+        return slot && sellBookAt(*slot);
+    }
+
+    // Take count copies of the book at slot if that many are in stock; never oversells
+    bool sellBookAt(size_t slot, int count = 1) {
+        auto counter = stock(slot);
+        int current = counter.load(memory_order_relaxed);
+        while (current >= count) {
+            if (counter.compare_exchange_weak(current, current - count, memory_order_relaxed)) {
+                header->changes.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Slot of a book by title, looked up in the shared index
+    optional<size_t> findBook(string_view title) const {
+        size_t mask = header->bucketCount - 1;
+        for (size_t i = titleHash(title) & mask;; i = (i + 1) & mask) {
+            uint32_t entry = atomic_ref<uint32_t>(buckets[i]).load(memory_order_acquire);
+            if (entry == 0) {
+                return nullopt;
+            }
+            if (titleOf(entry - 1) == title) {
+                return entry - 1;
+            }
+        }
+    }
+
+    // Number of books (every slot below it is complete)
+    size_t size() const { return header->count.load(memory_order_acquire); }
+
+    // Current quantity of the book at slot
+    int quantity(size_t slot) const { return stock(slot).load(memory_order_relaxed); }
+
+    // Copy of the book at slot, with its current quantity
+    Book getBook(size_t slot) const {
+        const Record& record = records[slot];
+        return Book::fromCents(string(titleOf(slot)), authorOf(slot), record.priceCents, quantity(slot));
+    }
+
+    // Copies of all books, for saving or handing to a Library
+    vector<Book> books() const {
+        vector<Book> all;
+        size_t n = size();
+        all.reserve(n);
+        for (size_t slot = 0; slot < n; slot++) {
+            all.push_back(getBook(slot));
+        }
+        return all;
+    }
+
+    // Stream books to out, optionally filtered and paged (as Library::exportInventory)
+    size_t exportInventory(ostream& out, const ExportOptions& options) const {
+        InventoryExporter exporter(out, options.format);
+        size_t skipped = 0, written = 0, n = size();
+        for (size_t slot = 0; slot < n && written < options.limit; slot++) {
+            Book book = getBook(slot);
+            if (options.filter && !options.filter(book, book.getQuantity())) {
+                continue;
+            }
+            if (skipped < options.offset) {
+                skipped++;
+                continue;
+            }
+            exporter.write(slot, book);
+            written++;
+        }
+        return written;
+    }
+
+    // Become the process that saves the inventory. Succeeds if nobody owns persistence, if this
+    // process already does, or if the owner has exited without letting go.
+    bool claimPersistence() {
+        int me = getpid();
+        int owner = header->persistenceOwner.load();
+        while (owner != me) {
+            if (owner != 0 && (kill(owner, 0) == 0 || errno == EPERM)) {
+                return false;  // Owned by a live process
+            }
+            if (header->persistenceOwner.compare_exchange_weak(owner, me)) {
+                return true;
+            }
+        }
+        return true;
+    }
+
+    // Give up persistence (also done when the owner detaches)
+    void releasePersistence() {
+        int me = getpid();
+        header->persistenceOwner.compare_exchange_strong(me, 0);
+    }
+
+    // Save the whole inventory if anything changed since the last save by any owner.
+    // Only the persistence owner may call this. Returns whether it wrote.
+    bool saveIfChanged(FileStorageBase& storage, const string& filename) {
+        uint64_t seen = header->changes.load(memory_order_acquire);
+        if (seen == header->savedChanges.load(memory_order_relaxed)) {
+            return false;
+        }
+        storage.saveToFile(books(), filename);
+        header->savedChanges.store(seen, memory_order_relaxed);
+        return true;
+    }
+
+private:
+    static constexpr uint64_t kMagic = 0x4c4d53534852ull;  // Set once the segment is ready
+
+    // Segment header, at the start of the mapping
+    struct alignas(64) Header {
+        atomic<uint64_t> magic{0};
+        uint64_t capacity = 0;  // Record slots
+        uint64_t bucketCount = 0;  // Title index buckets (a power of two)
+        uint64_t arenaBytes = 0;  // Bytes for titles and authors
+        uint64_t arenaUsed = 0;  // Guarded by appendMutex
+        atomic<uint32_t> count{0};  // Books published
+        atomic<int32_t> persistenceOwner{0};  // Pid of the process that saves, 0 if none
+        atomic<uint64_t> changes{0};  // Stock changes and additions so far
+        atomic<uint64_t> savedChanges{0};  // Value of changes at the last save
+        pthread_mutex_t appendMutex;  // Process-shared, robust; serializes addBook
+    };
+
+    // One book; strings live in the arena
+    struct Record {
+        uint64_t titleOffset;
+        uint64_t authorOffset;
+        uint32_t titleLength;
+        uint32_t authorLength;
+        int64_t priceCents;
+        int32_t quantity;  // Accessed through atomic_ref only
+    };
+
+    static_assert(atomic_ref<int32_t>::is_always_lock_free && atomic_ref<uint32_t>::is_always_lock_free,
+                  "shared quantities need address-free atomics");
+
+    // Where each part of the segment starts
+    struct Layout {
+        Layout(size_t capacity, size_t bucketCount, size_t arenaBytes) {
+            records = sizeof(Header);
+            buckets = records + capacity * sizeof(Record);
+            arena = buckets + bucketCount * sizeof(uint32_t);
+            total = arena + arenaBytes;
+        }
+        size_t records, buckets, arena, total;
+    };
+
+    SharedInventory(void* base, size_t length) : base(base), length(length), header(static_cast<Header*>(base)) {
+        Layout layout(header->capacity, header->bucketCount, header->arenaBytes);
+        char* bytes = static_cast<char*>(base);
+        records = reinterpret_cast<Record*>(bytes + layout.records);
+        buckets = reinterpret_cast<uint32_t*>(bytes + layout.buckets);
+        arena = bytes + layout.arena;
+    }
+
+    // FNV-1a: the same in every process and build, unlike std::hash
+    static uint64_t titleHash(string_view title) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : title) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    string_view titleOf(size_t slot) const { return string_view(arena + records[slot].titleOffset, records[slot].titleLength); }
+    string_view authorOf(size_t slot) const { return string_view(arena + records[slot].authorOffset, records[slot].authorLength); }
+    atomic_ref<int32_t> stock(size_t slot) const { return atomic_ref<int32_t>(records[slot].quantity); }
+
+    // Append a book under the shared mutex and publish it; false if the segment is full
+    bool append(const Book& book) {
+        if (pthread_mutex_lock(&header->appendMutex) == EOWNERDEAD) {
+            // A process died while adding; at worst its last book was counted but never indexed
+            pthread_mutex_consistent(&header->appendMutex);
+        }
+        size_t slot = header->count.load(memory_order_relaxed);
+        const string& title = book.getTitle();
+        const string& author = book.getAuthor();
+        if (slot >= header->capacity || header->arenaUsed + title.size() + author.size() > header->arenaBytes) {
+            pthread_mutex_unlock(&header->appendMutex);
+            return false;
+        }
+        Record& record = records[slot];
+        record.titleOffset = header->arenaUsed;
+        record.titleLength = static_cast<uint32_t>(title.size());
+        memcpy(arena + record.titleOffset, title.data(), title.size());
+        record.authorOffset = record.titleOffset + title.size();
+        record.authorLength = static_cast<uint32_t>(author.size());
+        memcpy(arena + record.authorOffset, author.data(), author.size());
+        record.priceCents = book.getPriceCents();
+        record.quantity = book.getQuantity();
+        header->arenaUsed += title.size() + author.size();
+        header->count.store(static_cast<uint32_t>(slot + 1), memory_order_release);
+
+        // Index the title unless an earlier book has it (the first copy owns the entry, as in Library)
+        size_t mask = header->bucketCount - 1;
+        for (size_t i = titleHash(title) & mask;; i = (i + 1) & mask) {
+            uint32_t entry = atomic_ref<uint32_t>(buckets[i]).load(memory_order_relaxed);
+            if (entry == 0) {
+                atomic_ref<uint32_t>(buckets[i]).store(static_cast<uint32_t>(slot + 1), memory_order_release);
+                break;
+            }
+            if (titleOf(entry - 1) == title) {
+                break;
+            }
+        }
+        header->changes.fetch_add(1, memory_order_release);
+        pthread_mutex_unlock(&header->appendMutex);
+        return true;
+    }
+
+    void* base;  // Start of the mapping
+    size_t length;  // Bytes mapped
+    Header* header;
+    Record* records;  // capacity records
+    uint32_t* buckets;  // Title index: record slot + 1, or 0 for an empty bucket
+    char* arena;  // Titles and authors
+};
+
+#endif // SHAREDINVENTORY_H
@@ -0,0 +1,120 @@
+#ifndef SORTEDRUNINDEX_H
+#define SORTEDRUNINDEX_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+using namespace std;
+
+// SortedRunIndex Class: Ordered (key, slot) index built from sorted runs
+// Recent inserts collect in a small unsorted tail. A full tail is sorted into a new run, and runs are
+// merged pairwise whenever the newer one grows to half the size of the older one, so there are only
+// O(log n) runs and each entry is moved O(log n) times in total. A range scan binary-searches each run
+// and merges them, walking contiguous memory. Equal keys are ordered by slot. Scans are const and may
+// run concurrently with each other; the owner serializes them against inserts.
+template <typename Key>
+class SortedRunIndex {
+public:
+    using Entry = pair<Key, uint32_t>;
+
+    // Add one entry
+    void insert(Key key, uint32_t slot) {
+        tail.emplace_back(std::move(key), slot);
+        if (tail.size() >= kMaxTail) {
+            addRun(std::move(tail));
+            tail.clear();
+        }
+    }
+
+    // Add many entries as one sorted run
+    void insertBulk(vector<Entry>&& entries) {
+        addRun(std::move(entries));
+    }
+
+    size_t size() const {
+        size_t total = tail.size();
+        for (const auto& run : runs) {
+            total += run.size();
+        }
+        return total;
+    }
+
+    // Visit entries in key order starting at the first key >= from.
+    // inRange(key) ends the scan when it returns false; visit(entry) ends it by returning false.
+    template <typename InRange, typename Visit>
+    void scan(const Key& from, InRange inRange, Visit visit) const {
+        vector<const Entry*> recent;
+        for (const auto& e : tail) {
+            if (!(e.first < from) && inRange(e.first)) {
+                recent.push_back(&e);
+            }
+        }
+        sort(recent.begin(), recent.end(), [](const Entry* a, const Entry* b) { return *a < *b; });
+
+        // One cursor per run plus one over the sorted tail matches; repeatedly take the smallest
+        struct Cursor {
+            const Entry* next;
+            const Entry* end;
+        };
+        vector<Cursor> cursors;
+        for (const auto& run : runs) {
+            auto it = lower_bound(run.begin(), run.end(), from, [](const Entry& e, const Key& k) { return e.first < k; });
+            if (it != run.end()) {
+                cursors.push_back({&*it, run.data() + run.size()});
+            }
+        }
+        size_t nextRecent = 0;
+        while (true) {
+            const Entry* best = nullptr;
+            size_t bestCursor = cursors.size();
+            for (size_t i = 0; i < cursors.size(); i++) {
+                if (cursors[i].next != cursors[i].end && (!best || *cursors[i].next < *best)) {
+                    best = cursors[i].next;
+                    bestCursor = i;
+                }
+            }
+            if (nextRecent < recent.size() && (!best || *recent[nextRecent] < *best)) {
+                best = recent[nextRecent];
+                bestCursor = cursors.size();
+            }
+            if (!best || !inRange(best->first)) {
+                return;
+            }
+            if (bestCursor < cursors.size()) {
+                cursors[bestCursor].next++;
+            } else {
+                nextRecent++;
+            }
+            if (!visit(*best)) {
+                return;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kMaxTail = 1024;  // Inserts buffered before they become a run
+
+    // Sort entries into a run and merge runs until sizes shrink geometrically from oldest to newest
+    void addRun(vector<Entry>&& entries) {
+        if (entries.empty()) {
+            return;
+        }
+        sort(entries.begin(), entries.end());
+        runs.push_back(std::move(entries));
+        while (runs.size() >= 2 && runs[runs.size() - 2].size() <= 2 * runs.back().size()) {
+            vector<Entry>& older = runs[runs.size() - 2];
+            vector<Entry>& newer = runs.back();
+            size_t middle = older.size();
+            older.insert(older.end(), make_move_iterator(newer.begin()), make_move_iterator(newer.end()));
+            inplace_merge(older.begin(), older.begin() + middle, older.end());
+            runs.pop_back();
+        }
+    }
+
+    vector<vector<Entry>> runs;  // Sorted runs, oldest (largest) first
+    vector<Entry> tail;  // Recent inserts, unsorted
+};
+
+#endif // SORTEDRUNINDEX_H
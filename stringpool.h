@@ -0,0 +1,49 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <mutex>
+using namespace std;
+
+// StringPool Class: Process-wide interning pool for strings that repeat across many books
+// Each distinct string is stored once and handed out as a stable reference, so Books can keep a
+// pointer instead of their own copy. Entries are never freed. The pool is split into shards with
+// their own lock so loaders on several threads rarely wait on each other.
+class StringPool {
+public:
+    // Pool shared by all Books for author names
+    static StringPool& authors() {
+        static StringPool pool;
+        return pool;
+    }
+
+    // Return the pooled copy of text, adding it on first use
+    const string& intern(string_view text) {
+        size_t h = hash<string_view>{}(text);
+        Shard& shard = shards[h % kShards];
+        lock_guard guard(shard.lock);
+        auto it = shard.strings.find(text);
+        if (it == shard.strings.end()) {
+            it = shard.strings.emplace(text).first;
+        }
+        return *it;
+    }
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(string_view text) const { return hash<string_view>{}(text); }
+    };
+
+    struct Shard {
+        mutex lock;
+        unordered_set<string, Hash, equal_to<>> strings;  // Node-based, so references stay valid on rehash
+    };
+
+    static constexpr size_t kShards = 16;
+    Shard shards[kShards];
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,177 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+using namespace std;
+
+// ThreadPool Class: Fixed set of worker threads running submitted tasks in FIFO order
+// Tasks may submit more tasks. The destructor finishes every queued task before joining.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = thread::hardware_concurrency()) {
+        threads = max<size_t>(threads, 1);
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard lock(mutex_);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task and get a future for its result
+    template <typename F>
+    auto submit(F&& task) -> future<invoke_result_t<F>> {
+        auto packaged = make_shared<packaged_task<invoke_result_t<F>()>>(std::forward<F>(task));
+        auto result = packaged->get_future();
+        post([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    // Queue a task without tracking its completion
+    void post(function<void()> task) {
+        // Notify under the lock: once the task runs, its owner may destroy the pool (as
+        // ~CheckoutPipeline does when the last checkout finishes), so post must not touch it afterwards
+        lock_guard lock(mutex_);
+        tasks.push_back(std::move(task));
+        wake.notify_one();
+    }
+
+    size_t size() const { return workers.size(); }
+
+private:
+    void run() {
+        unique_lock lock(mutex_);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;  // Stopping and nothing left to run
+            }
+            function<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    mutex mutex_;
+    condition_variable wake;  // Signals workers that a task arrived or the pool is stopping
+    deque<function<void()>> tasks;  // Queued tasks, oldest first
+    bool stopping = false;
+    vector<thread> workers;  // Declared last so they start after every other member is ready
+};
+
+// TimerQueue Class: One thread that runs callbacks when their deadlines pass
+// Callbacks run on the timer thread, so they should be short or hand their work to a pool.
+// A timer that is no longer needed can be cancelled, which frees its callback at once.
+// Callbacks still waiting when the queue is destroyed run immediately, so none is ever lost.
+class TimerQueue {
+public:
+    using Clock = chrono::steady_clock;
+    // Identifies a scheduled callback; the sequence breaks ties so equal deadlines fire in scheduling order
+    using TimerId = pair<Clock::time_point, uint64_t>;
+
+    TimerQueue() : worker([this] { run(); }) {}
+
+    ~TimerQueue() {
+        {
+            lock_guard lock(mutex_);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    // Run callback once deadline has passed
+    TimerId schedule(Clock::time_point deadline, function<void()> callback) {
+        TimerId id;
+        bool earliest;
+        {
+            lock_guard lock(mutex_);
+            id = {deadline, sequence++};
+            auto inserted = timers.emplace(id, std::move(callback)).first;
+            earliest = inserted == timers.begin();
+        }
+        if (earliest) {
+            wake.notify_one();  // The timer thread may be sleeping toward a later deadline
+        }
+        return id;
+    }
+
+    // Run callback after delay
+    TimerId scheduleAfter(Clock::duration delay, function<void()> callback) {
+        return schedule(Clock::now() + delay, std::move(callback));
+    }
+
+    // Drop a callback that has not started yet. Returns false if it already ran, is running or was cancelled.
+    bool cancel(const TimerId& id) {
+        lock_guard lock(mutex_);
+        return timers.erase(id) != 0;
+    }
+
+    // Callbacks waiting for their deadline
+    size_t pending() {
+        lock_guard lock(mutex_);
+        return timers.size();
+    }
+
+private:
+    void run() {
+        unique_lock lock(mutex_);
+        while (true) {
+            if (timers.empty()) {
+                if (stopping) {
+                    return;
+                }
+                wake.wait(lock);
+                continue;
+            }
+            auto next = timers.begin();
+            Clock::time_point deadline = next->first.first;  // Copied: cancel may erase the node while waiting
+            if (!stopping && Clock::now() < deadline) {
+                wake.wait_until(lock, deadline);
+                continue;
+            }
+            function<void()> callback = std::move(next->second);
+            timers.erase(next);
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+
+    mutex mutex_;
+    condition_variable wake;  // Signals a new earliest deadline or shutdown
+    map<TimerId, function<void()>> timers;  // Earliest deadline first
+    uint64_t sequence = 0;
+    bool stopping = false;
+    thread worker;  // Declared last so it starts after every other member is ready
+};
+
+#endif // THREADPOOL_H